@@ -0,0 +1,66 @@
+/* afford.c
+ *
+ * Author: Michael Bossner
+ *
+ * afford.c keeps track of which markets each player can afford. Each player
+ * has a mask with a bit for each market that is only changed by the events
+ * that change it so strategies can find what to buy without checking every
+ * card again.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "afford.h"
+#include "board.h"
+#include "costs.h"
+#include "lib.h"
+
+////////////////////////////////// Functions //////////////////////////////////
+
+bool can_afford(GameState* state, int player, Card* card) {
+    long wild = state->player.wildPile[player];
+
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        long missing = card->cost[colour] - 
+                (state->player.tokens[player][colour] + 
+                state->player.discountList[player][colour]);
+        if (missing > wild) { // more than the wild tokens left
+            return false;
+        } else if (missing > 0) { // must use wild tokens
+            wild -= missing;
+        }
+    }
+    return true;
+}
+
+void clear_affordable(GameState* state) {
+    memset(state->player.affordable, 0, sizeof(state->player.affordable));
+}
+
+void update_affordable(GameState* state, int player) {
+    state->player.affordable[player] = affordable_markets(state, player);
+}
+
+void add_affordable(GameState* state, int boardIndex) {
+    Card* card = check_market_card(state, boardIndex);
+
+    for (int player = 0; player < state->player.count; player++) {
+        if (can_afford(state, player, card)) {
+            state->player.affordable[player] |= 1ULL << boardIndex;
+        } else {
+            state->player.affordable[player] &= ~(1ULL << boardIndex);
+        }
+    }
+}
+
+void remove_affordable(GameState* state, int boardIndex) {
+    unsigned long long older = (1ULL << boardIndex) - 1;
+
+    for (int player = 0; player < state->player.count; player++) {
+        unsigned long long mask = state->player.affordable[player];
+        state->player.affordable[player] = (mask & older) | 
+                ((mask >> 1) & ~older);
+    }
+}
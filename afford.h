@@ -0,0 +1,73 @@
+/* afford.h
+ *
+ * Author: Michael Bossner
+ *
+ * afford.h header file for afford.c
+ */
+
+#ifndef AFFORD_H
+#define AFFORD_H
+
+#include <stdbool.h>
+
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+/* Checks if the bit of a market is set in an affordable mask */
+#define IS_AFFORDABLE(mask, boardIndex) (((mask) >> (boardIndex)) & 1ULL)
+
+///////////////////////// Public Functions Prototypes /////////////////////////
+
+/*
+ * Checks if a player has enough tokens, discounts and wild tokens to buy a
+ * card
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player buying the card
+ *
+ * card: card to be bought
+ *
+ * return: returns true if the player can afford the card else false
+ */
+bool can_afford(GameState* state, int player, Card* card);
+
+/*
+ * Clears the affordable markets of every player. Used when the board is
+ * emptied.
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+void clear_affordable(GameState* state);
+
+/*
+ * Works out again which markets a player can afford. Must be called after
+ * the tokens, wild tokens or discounts of the player change.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player whose tokens changed
+ */
+void update_affordable(GameState* state, int player);
+
+/*
+ * Works out which players can afford a market that was just set up
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * boardIndex: index of the new market
+ */
+void add_affordable(GameState* state, int boardIndex);
+
+/*
+ * Removes a market from the affordable markets of every player. The bits
+ * of younger markets move down one to match their new board indexes.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * boardIndex: index of the market removed
+ */
+void remove_affordable(GameState* state, int boardIndex);
+
+#endif
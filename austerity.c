@@ -5,6 +5,8 @@
  * austerity.c is the main file for the Austerity Hub program
  */
 
+#define _GNU_SOURCE // pipe2
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -15,24 +17,36 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <stdbool.h>
+#include <string.h>
+#include <dlfcn.h>
 
 #include "lib.h"
-#include "token.h"
 #include "deck.h"
 #include "endAusterity.h"
 #include "board.h"
 #include "game.h"
+#include "loop.h"
+#include "plugin.h"
+#include "transport.h"
+#include "comms.h"
+#include "ring.h"
+#include "strategy.h"
+#include "broadcast.h"
+#include "wire.h"
 
 /////////////////////////////////// Defines ///////////////////////////////////
 
 #define MIN_ARGS 6
 #define MAX_ARGS 30
-#define STDIN 0
-#define STDOUT 1
-#define STDERR 2
 #define PIPE_FAIL -1
 #define FLAGGED 1
-#define BUFFER 10
+#define OPTIONS "+g:k:t:T:x:scm:p:zM:Hn:b"
+#define DEFAULT_GAMES 1
+#define DEFAULT_GRACE 2000
+#define READY_TIMEOUT 5000
+#define READY_MESSAGE "ready"
+#define PLUGIN_SUFFIX ".so"
+#define MAX_NAME 32
 
 /* Program argument indexes */
 enum ArgIndex {
@@ -45,12 +59,55 @@ enum ArgIndex {
 //////////////////////// Private Functions Prototypes /////////////////////////
 
 /*
- * Initializes the state variables of the game.
+ * Parses the options given before the tokens argument and sets the values
+ * into the hub config. Options are
+ *
+ * -g games: Number of games to play back to back with the same players.
+ *           Must be a number greater than 0.
+ *
+ * -k grace: Milliseconds players are given to exit after the eog message
+ *           before they are killed. Must be a positive number.
+ *
+ * -t move: Milliseconds a player has to reply to each dowhat. 
+ *          Must be a number greater than 0.
+ *
+ * -T total: Milliseconds a player has to reply to all dowhats in a game.
+ *           Must be a number greater than 0.
+ *
+ * -x policy: What happens when a player runs out of time. Either "error"
+ *            (protocol error, the default), "forfeit" (player loses the turn)
+ *            or "wild" (player takes a wild token).
+ *
+ * -s: Print statistics to stderr when the game is over.
+ *
+ * -c: Coalesce output. Messages are queued and written to each player once
+ *     just before its next dowhat or eog.
+ *
+ * -m transport: How player programs are connected to the hub. Either 
+ *               "pipe" (the default), "socket" or "shm".
+ *
+ * -p spin: Microseconds the hub and shm players busy poll a ring before 
+ *          sleeping on it. Must be a positive number. Defaults to 0.
+ *
+ * -H: Headless. The built in strategy each player is named after plays
+ *     inside the hub and only the winners of each game are printed.
+ *
+ * -n tables: Number of tables to play at once. Every table starts its own
+ *            players and plays all of its games. Must be from 1 to 256.
+ *
+ * -b: Offer each player the binary protocol once it is ready. Players that
+ *     agree are sent records and reply with records instead of text.
+ *
+ * argc: number of arguments passed into austerity
+ *
+ * argv: all arguments passed into austerity
  *
  * state: Contains all information needed to keep track of the game
  *
+ * return: Returns -1 if an option is unknown or has an invalid value
+ *         else returns the index of the first argument after the options
  */
-static void init_state(GameState* state);
+static int process_options(int argc, char** argv, GameState* state);
 
 /*
  * Parses the tokens and points arguments and sets the values into the state
@@ -67,7 +124,28 @@ static void init_state(GameState* state);
 static int process_args(char* tokens, char* points, GameState* state);
 
 /*
- * Sets up and starts all player processes for the game
+ * Hosts state->config.tables tables at once. Each table gets a copy of the
+ * state with its own deck and players and every table plays until its games
+ * are over or it ends on an error. Exits once every table has ended. A
+ * table that fails to start ends on its own like a table that fails while
+ * playing.
+ *
+ * state: state every table is copied from. The deck must not be loaded
+ *
+ * argv: all arguments passed into austerity including all player names
+ *
+ * argc: number of arguments passed into austerity
+ *
+ * Exits with the status of the first table that ended on an error or 0 if
+ * the games at every table are over
+ */
+static void host_tables(GameState* state, char** argv, int argc);
+
+/*
+ * Sets up and starts all player processes for the game using the transport
+ * chosen with -m. A player ending in ".so" is loaded as a plugin instead and
+ * plays inside the hub. A player of the form "unix:PATH" is a daemon that
+ * is already running and is connected to instead of started.
  *
  * state: Contains all information needed to keep track of the game
  *
@@ -75,13 +153,96 @@ static int process_args(char* tokens, char* points, GameState* state);
  *
  * argc: all arguments passed into austerity including all player names
  *
- * Error 6: Bad start. Failed to set up a player process
+ * Error 6: Bad start. Failed to set up a player process, plugin or daemon
  */
 static void process_players(GameState* state, char** argv, int argc);
 
+/*
+ * Sets a player to use the built in strategy it is named after. The
+ * directory and any suffix of the name are ignored so "./shenzi" and
+ * "shenzi.so" are both shenzi.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player
+ *
+ * name: player argument passed into austerity
+ *
+ * Error 6: Bad start. There is no strategy with that name
+ */
+static void load_builtin(GameState* state, int player, char* name);
+
+/*
+ * Loads a player plugin with dlopen() and prepares it to play as the
+ * given player. The plugin must export plugin_init() and plugin_do_what()
+ * as declared in plugin.h
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player the plugin will play as
+ *
+ * path: path of the plugin to load
+ *
+ * Error 6: Bad start. The plugin could not be loaded or did not accept the
+ *          player count and index
+ */
+static void load_plugin(GameState* state, int player, char* path);
+
+/*
+ * Checks if a player argument names a plugin
+ *
+ * name: player argument passed into austerity
+ *
+ * return: returns true if the name ends in ".so" else false
+ */
+static bool is_plugin_name(char* name);
+
+/*
+ * Starts watching every player in the event loop and waits for each of them
+ * to send the ready message on its pipe. All pipes are waited on at once so
+ * startup only takes as long as the slowest player.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * Error 5: Bad start. A player died, closed its pipe, sent something other
+ *          than the ready message or was not ready within 5 seconds
+ *
+ * Error 10: Received SIGINT
+ */
+static void wait_for_players(GameState* state);
+
+/*
+ * Runs the event loop until every player of the table is ready. Can be
+ * called again if another table ended while this one was waiting.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * Error 5: Bad start. A player failed to exec or was not ready in time
+ *
+ * Error 10: Received SIGINT
+ */
+static void wait_ready(GameState* state);
+
+/*
+ * Line handler used while players are starting. Marks the player as ready.
+ * With -b the player is offered the binary protocol first and is only ready
+ * once it has agreed to it or declined.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player who sent the line
+ *
+ * line: line that was sent. NULL if the player closed its pipe
+ *
+ * Error 5: Bad start. The line was not the ready message or a reply to the
+ *          offer, the player was already ready or the player closed its pipe
+ */
+static void player_ready(GameState* state, int player, char* line);
+
 /*
  * Signal handler for SIGINT, SIGCHLD and SIGPIPE. Sets values to the 
- * global variable sigStore.
+ * global variable sigStore. Every child that has exited is reaped on SIGCHLD
+ * as several exits can be delivered as a single signal.
  *
  * sigNo: signal identifier
  */
@@ -91,6 +252,7 @@ static void handle_signals(int sigNo);
 
 int main(int argc, char** argv) {
     GameState state;
+    EventLoop loop;
 
     struct sigaction sigAct;
     sigAct.sa_handler = handle_signals;
@@ -98,14 +260,50 @@ int main(int argc, char** argv) {
 
     // initialize the sigStore global variable
     sigStore.index = 0;
-    sigStore.badStart = false;
     sigStore.sigIntCaught = false;
     sigStore.sigPipeCaught = false;
     sigStore.childSignaled = false;
+    sigStore.wakeBell = NULL;
+    if (pipe2(sigStore.wakePipe, O_NONBLOCK | O_CLOEXEC) == PIPE_FAIL) {
+        sigStore.wakePipe[READ] = INVALID;
+        sigStore.wakePipe[WRITE] = INVALID;
+    }
 
     sigaction(SIGINT, &sigAct, NULL);
     sigaction(SIGCHLD, &sigAct, NULL);
     sigaction(SIGPIPE, &sigAct, NULL);
+
+    // nothing has been set up yet so there is nothing to clean up
+    state.player.count = 0;
+    state.deck.size = 0;
+    state.deck.cards = NULL;
+    state.deck.mapLength = 0;
+    state.deck.stream = NULL;
+    state.loop = &loop;
+    memset(&state.clock, 0, sizeof(Clock));
+    memset(&state.traffic, 0, sizeof(Traffic));
+    memset(state.player.commsList, 0, sizeof(state.player.commsList));
+    memset(state.player.pidList, 0, sizeof(state.player.pidList));
+    memset(state.player.strategies, 0, sizeof(state.player.strategies));
+    memset(state.player.plugins, 0, sizeof(state.player.plugins));
+    memset(state.player.outboxes, 0, sizeof(state.player.outboxes));
+    memset(state.player.rings, 0, sizeof(state.player.rings));
+    memset(state.player.binary, 0, sizeof(state.player.binary));
+    memset(state.player.readers, 0, sizeof(state.player.readers));
+    memset(&state.progress, 0, sizeof(Progress));
+    state.player.link = NULL;
+    state.table = 0;
+    state.tableEnd = NULL;
+    init_board(&state);
+
+    int optionEnd = process_options(argc, argv, &state);
+    if (optionEnd == INVALID) {
+        end_austerity(&state, INVALID_ARG);
+    }
+    // skip the options so the argument indexes stay the same
+    argc -= (optionEnd - 1);
+    argv += (optionEnd - 1);
+    state.board.size = state.config.markets;
     
     if (!is_num_args_valid(argc, MIN_ARGS, MAX_ARGS)) {
         end_austerity(&state, WRONG_NUM_ARGS);
@@ -115,34 +313,143 @@ int main(int argc, char** argv) {
         end_austerity(&state, INVALID_ARG);
     }
 
-    init_state(&state);
+    reset_game(&state);
+
+    if (!state.config.headless && (sigStore.wakePipe[READ] == INVALID || 
+            !init_loop(&loop))) {
+        end_austerity(&state, BAD_START);
+    }
+    if (state.config.tables > 1) {
+        host_tables(&state, argv, argc);
+    }
 
     load_deck_file(argv[DECK_FILE], &state);
 
     process_players(&state, argv, argc);    
 
-    game_loop(&state);
+    void (*play)(GameState*) = state.config.headless ? headless_game : 
+            game_loop;
+    for (state.game = 1; state.game < state.config.games; state.game++) {
+        play(&state);
+        next_game(&state);
+        free_board(&state);
+        reset_game(&state);
+        rewind_deck(&state);
+    }
+    play(&state);
     
-    end_austerity(&state, GAME_OVER); // will never get to this line.
+    end_austerity(&state, GAME_OVER);
 }
 
 ////////////////////////////// Private Functions //////////////////////////////
 //
-static void init_state(GameState* state) {
-    init_board(state);
-    init_tokens(state);
-
-    state->currentPlayer = 0;
-
-    for (int player = 0; player < MAX_PLAYERS; player++) {
-        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
-            state->player.discountList[player][colour] = 0;
-            state->player.tokens[player][colour] = 0;
+static int process_options(int argc, char** argv, GameState* state) {
+    int option;
+    state->config.games = DEFAULT_GAMES;
+    state->config.graceTime = DEFAULT_GRACE;
+    state->config.moveTime = 0;
+    state->config.totalTime = 0;
+    state->config.timeoutPolicy = TIMEOUT_ERROR;
+    state->config.stats = false;
+    state->config.coalesce = false;
+    state->config.transport = find_transport(DEFAULT_TRANSPORT);
+    state->config.spin = 0;
+    state->config.streamDeck = false;
+    state->config.markets = DEFAULT_MARKETS;
+    state->config.headless = false;
+    state->config.tables = 1;
+    state->config.binary = false;
 
+    opterr = 0; // bad options are reported as a bad argument
+    while ((option = getopt(argc, argv, OPTIONS)) != INVALID) {
+        switch (option) {
+            case 'g':
+                state->config.games = is_str_pos_number(optarg);
+                if (state->config.games < 1) {
+                    return INVALID;
+                }
+                break;
+            case 'k':
+                state->config.graceTime = is_str_pos_number(optarg);
+                if (state->config.graceTime == INVALID || 
+                        optarg[0] == '\0') {
+                    return INVALID;
+                }
+                break;
+            case 't':
+                state->config.moveTime = is_str_pos_number(optarg);
+                if (state->config.moveTime < 1) {
+                    return INVALID;
+                }
+                break;
+            case 'T':
+                state->config.totalTime = is_str_pos_number(optarg);
+                if (state->config.totalTime < 1) {
+                    return INVALID;
+                }
+                break;
+            case 'x':
+                if (strcmp(optarg, "error") == 0) {
+                    state->config.timeoutPolicy = TIMEOUT_ERROR;
+                } else if (strcmp(optarg, "forfeit") == 0) {
+                    state->config.timeoutPolicy = TIMEOUT_FORFEIT;
+                } else if (strcmp(optarg, "wild") == 0) {
+                    state->config.timeoutPolicy = TIMEOUT_WILD;
+                } else {
+                    return INVALID;
+                }
+                break;
+            case 's':
+                state->config.stats = true;
+                break;
+            case 'c':
+                state->config.coalesce = true;
+                break;
+            case 'z':
+                state->config.streamDeck = true;
+                break;
+            case 'M':
+                state->config.markets = is_str_pos_number(optarg);
+                if (state->config.markets < 1 || 
+                        state->config.markets > MAX_MARKETS) {
+                    return INVALID;
+                }
+                break;
+            case 'H':
+                state->config.headless = true;
+                break;
+            case 'b':
+                state->config.binary = true;
+                break;
+            case 'n':
+                state->config.tables = is_str_pos_number(optarg);
+                if (state->config.tables < 1 || 
+                        state->config.tables > MAX_TABLES) {
+                    return INVALID;
+                }
+                break;
+            case 'p':
+                state->config.spin = is_str_pos_number(optarg);
+                if (state->config.spin == INVALID || optarg[0] == '\0') {
+                    return INVALID;
+                }
+                break;
+            case 'm':
+                state->config.transport = find_transport(optarg);
+                if (state->config.transport == NULL) {
+                    return INVALID;
+                }
+                break;
+            default: // unknown option or missing value
+                return INVALID;
         }
-        state->player.scoreCard[player] = 0;
-        state->player.wildPile[player] = 0;
     }
+    // shm players all share the one link and bell of the hub
+    if (state->config.tables > 1 && (state->config.headless || 
+            strcmp(state->config.transport->name, SHM_TRANSPORT) == 0)) {
+        return INVALID;
+    }
+    return optind;
 }
 
 //
@@ -158,6 +465,39 @@ static int process_args(char* tokens, char* points, GameState* state) {
     return VALID;
 }
 
+//
+static void host_tables(GameState* state, char** argv, int argc) {
+    GameState* tables = calloc(state->config.tables, sizeof(GameState));
+    jmp_buf startEnd;
+    volatile int table; // kept when a table ends while starting
+    int status = GAME_OVER;
+
+    if (tables == NULL) {
+        end_austerity(state, BAD_START);
+    }
+    for (table = 0; table < state->config.tables; table++) {
+        memcpy(&tables[table], state, sizeof(GameState));
+        tables[table].table = table + 1;
+        tables[table].tableEnd = &startEnd; // the tables started keep going
+        if (setjmp(startEnd) == 0) {
+            load_deck_file(argv[DECK_FILE], &tables[table]);
+            process_players(&tables[table], argv, argc);
+        } else if (!tables[table].progress.ended) {
+            // a table already started ended while this one was waiting
+            wait_ready(&tables[table]);
+        }
+    }
+    play_tables(tables, state->config.tables);
+
+    for (int table = 0; table < state->config.tables; table++) {
+        if (status == GAME_OVER) {
+            status = tables[table].progress.status;
+        }
+    }
+    free(tables);
+    exit(status);
+}
+
 //
 static void process_players(GameState* state, char** argv, int argc) {  
     const int playerCount = (argc - PLAYER_START);
@@ -165,71 +505,169 @@ static void process_players(GameState* state, char** argv, int argc) {
 
     for (int i = PLAYER_START; i < argc; i++) { // for each player
         const int currentPlayer = (i - PLAYER_START);
-        int readWrite[READ_WRITE];
-        int writeRead[READ_WRITE];
-        if (pipe(readWrite) == PIPE_FAIL || (pipe(writeRead) == PIPE_FAIL)) {
-            end_austerity(state, BAD_START);
-        }   
-        if ((state->player.pidList[currentPlayer] = fork()) == 0) { // Child
-            int devNull = open("/dev/null", O_WRONLY);
-            char tempCount[BUFFER];          
-            sprintf(tempCount, "%d", playerCount); // setting up player args
-            char tempPlayer[BUFFER];
-            sprintf(tempPlayer, "%d", currentPlayer);
-            dup2(readWrite[WRITE], STDOUT); // redirecting pipes
-            dup2(writeRead[READ], STDIN);
-            dup2(devNull, STDERR);
-            close(devNull); // closing all unused files
-            close(readWrite[READ]);
-            close(readWrite[WRITE]);
-            close(writeRead[READ]);
-            close(writeRead[WRITE]);
-            execlp(argv[i], argv[i], tempCount, tempPlayer, (char*) NULL);
-            // exec failed. Gracefully exiting process
-            free_board(state);
-            free_deck(state);
-            for (int i = 0; i < currentPlayer; i++) {// close all previous pipe
-                fclose(state->player.commsList[i][READ]);
-                fclose(state->player.commsList[i][WRITE]);
+        long long start = time_now_us();
+        if (state->config.headless) {
+            load_builtin(state, currentPlayer, argv[i]);
+        } else if (is_plugin_name(argv[i])) {
+            load_plugin(state, currentPlayer, argv[i]);
+        } else if (is_unix_address(argv[i])) {
+            if (!connect_daemon(state, currentPlayer, argv[i])) {
+                end_austerity(state, BAD_START);
             }
-            exit(BAD_CHILD);        
-        } else if (state->player.pidList[currentPlayer] < 0) {  // Fork Failed
+        } else if (!state->config.transport->start(state, currentPlayer, 
+                argv[i])) {
             end_austerity(state, BAD_START);
-        } else {  // Parent
-            close(readWrite[WRITE]);
-            close(writeRead[READ]);
-            state->player.commsList[currentPlayer][READ] = 
-                    fdopen(readWrite[READ], "r");
-            state->player.commsList[currentPlayer][WRITE] = 
-                    fdopen(writeRead[WRITE], "w");
         }
+        state->clock.ready[currentPlayer] = time_now_us();
+        state->clock.spawn[currentPlayer] = 
+                state->clock.ready[currentPlayer] - start;
     }   
-    sleep(1); // Austerity was starting too quickly
+    if (!state->config.headless) {
+        wait_for_players(state);
+    }
+}
+
+//
+static void load_builtin(GameState* state, int player, char* name) {
+    char strategy[MAX_NAME];
+    char* base = strrchr(name, '/');
+
+    base = (base == NULL) ? name : &base[1];
+    snprintf(strategy, MAX_NAME, "%.*s", (int)strcspn(base, "."), base);
+    state->player.pidList[player] = 0;
+    if ((state->player.strategies[player] = find_strategy(strategy)) == NULL) {
+        end_austerity(state, BAD_START);
+    }
+}
+
+//
+static void load_plugin(GameState* state, int player, char* path) {
+    PluginInit init;
+    void* plugin;
+
+    state->player.pidList[player] = 0;
+    if ((plugin = dlopen(path, RTLD_NOW | RTLD_LOCAL)) == NULL) {
+        end_austerity(state, BAD_START);
+    }
+    state->player.plugins[player] = plugin;
+    // POSIX allows casting the void* from dlsym() to a function pointer
+    *(void**)(&init) = dlsym(plugin, PLUGIN_INIT);
+    *(void**)(&state->player.strategies[player]) = 
+            dlsym(plugin, PLUGIN_DO_WHAT);
+    if (init == NULL || state->player.strategies[player] == NULL || 
+            !init(state->player.count, player)) {
+        state->player.strategies[player] = NULL;
+        end_austerity(state, BAD_START);
+    }
+}
+
+//
+static bool is_plugin_name(char* name) {
+    size_t length = strlen(name);
+    size_t suffix = strlen(PLUGIN_SUFFIX);
+
+    return length > suffix && 
+            strcmp(&name[length - suffix], PLUGIN_SUFFIX) == 0;
+}
+
+//
+static void wait_for_players(GameState* state) {
+    state->progress.ready = 0;
+    state->progress.offered = 0;
+    state->progress.readyBy = time_now_us() + (READY_TIMEOUT * US_PER_MS);
+    state->lineHandler = player_ready;
+    for (int player = 0; player < state->player.count; player++) {
+        if (state->player.strategies[player] != NULL) { // plugins are ready
+            state->progress.ready |= (1 << player);
+            state->clock.ready[player] = 0;
+            continue;
+        }
+        if (state->player.rings[player][READ].ring != NULL) { // shm
+            watch_ring(state->loop, state, player, 
+                    &state->player.rings[player][READ], 
+                    &state->player.link->hubBell, state->config.spin);
+        } else if (!watch_player(state->loop, state, player, 
+                fileno(state->player.commsList[player][READ]))) {
+            end_austerity(state, BAD_START);
+        }
+    }
+    wait_ready(state);
+}
+
+//
+static void wait_ready(GameState* state) {
+    const int allReady = (1 << state->player.count) - 1;
+
+    while (state->progress.ready != allReady) {
+        long long timeLeft = state->progress.readyBy - time_now_us();
+        if (is_bad_start(state) || timeLeft <= 0) {
+            end_austerity(state, BAD_START);
+        } else if (sigStore.sigIntCaught) {
+            end_austerity(state, SIGINT_CAUGHT);
+        }
+        run_loop(state->loop, (timeLeft + US_PER_MS - 1) / US_PER_MS);
+    }
+}
+
+//
+static void player_ready(GameState* state, int player, char* line) {
+    const int bit = 1 << player;
+
+    if (line == NULL || (state->progress.ready & bit)) {
+        end_austerity(state, BAD_START);
+    } else if (state->progress.offered & bit) { // reply to the offer
+        if (strcmp(line, WIRE_OFFER) == 0) {
+            state->player.binary[player] = true;
+            state->player.readers[player].binary = true;
+        } else if (strcmp(line, WIRE_DECLINE) != 0) {
+            end_austerity(state, BAD_START);
+        }
+        state->progress.ready |= bit;
+        return;
+    } else if (strcmp(line, READY_MESSAGE) != 0) {
+        end_austerity(state, BAD_START);
+    }
+    state->clock.ready[player] = time_now_us() - state->clock.ready[player];
+    if (state->config.binary) {
+        send_player(state, player, WIRE_OFFER "\n");
+        flush_player(state, player);
+        state->progress.offered |= bit;
+        return;
+    }
+    state->progress.ready |= bit;
 }
 
 //
 static void handle_signals(int sigNo) {
     int status;
+    pid_t child;
     switch (sigNo) {
         case SIGINT:
             sigStore.sigIntCaught = true;
             break;
 
         case SIGCHLD:
-            sigStore.children[sigStore.index] = wait(&status);
-            if (WIFEXITED(status)) {
-                sigStore.status[sigStore.index] = WEXITSTATUS(status);
-            } else {
-                sigStore.status[sigStore.index] = WIFSIGNALED(status);
-                sigStore.childSignaled = true;
-            }
-            if (sigStore.status[sigStore.index] == BAD_CHILD) {
-                sigStore.badStart = true;
+            while (sigStore.index < MAX_CHILDREN && 
+                    (child = waitpid(-1, &status, WNOHANG)) > 0) {
+                sigStore.children[sigStore.index] = child;
+                if (WIFEXITED(status)) {
+                    sigStore.status[sigStore.index] = WEXITSTATUS(status);
+                } else {
+                    sigStore.status[sigStore.index] = WIFSIGNALED(status);
+                    sigStore.childSignaled = true;
+                }
+                sigStore.index++;
             }
-            sigStore.index++;
             break;
         case SIGPIPE:
             sigStore.sigPipeCaught = true;
             break;
     }
+    if (sigStore.wakePipe[WRITE] != INVALID) { // wake up the event loop
+        char wake = 0;
+        write(sigStore.wakePipe[WRITE], &wake, 1);
+    }
+    if (sigStore.wakeBell != NULL) { // the loop may be sleeping on the bell
+        ring_bell(sigStore.wakeBell);
+    }
 }
\ No newline at end of file
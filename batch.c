@@ -0,0 +1,275 @@
+/* batch.c
+ *
+ * Author: Michael Bossner
+ *
+ * batch.c is the main file for the batch runner. It runs every job in a job
+ * file as an austerity spread across all cores and writes the output of
+ * each job in job file order.
+ *
+ * Usage: batch [-j workers] [-t timeout] [-a austerity] [-H] jobs [output]
+ *
+ * -j workers: Number of jobs run at once. Defaults to the number of cores.
+ *
+ * -t timeout: Milliseconds a job may take before it is killed. Defaults to
+ *             no limit.
+ *
+ * -a austerity: Path of austerity. Defaults to the austerity next to batch.
+ *
+ * -H: Run every job with the headless engine.
+ *
+ * Throughput and jobs that took much longer than the rest are reported to
+ * stderr once every job has finished.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jobs.h"
+#include "lib.h"
+#include "endAusterity.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define OPTIONS "+j:t:a:H"
+#define MIN_ARGS 1
+#define MAX_ARGS 2
+#define CANNOT_OPEN_JOBS 2
+#define CANNOT_WRITE_OUTPUT 3
+#define CANNOT_RUN_JOBS 4
+#define AUSTERITY_NAME "austerity"
+#define STRAGGLER_FACTOR 4
+#define STRAGGLER_MIN 1000
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Parses the options given before the job file and sets them into the
+ * batch. See the usage at the top of this file.
+ *
+ * argc: number of arguments passed into batch
+ *
+ * argv: all arguments passed into batch
+ *
+ * batch: batch the options are set into
+ *
+ * return: returns -1 if an option is unknown or has an invalid value else
+ *         returns the index of the first argument after the options
+ */
+static int process_options(int argc, char** argv, Batch* batch);
+
+/*
+ * Works out the path of the austerity next to batch
+ *
+ * program: argv[0] of batch
+ *
+ * return: returns the path. Must be freed
+ */
+static char* find_austerity(char* program);
+
+/*
+ * Writes the output of a finished job between a header with its line and
+ * a footer with how it ended
+ *
+ * job: job to write
+ *
+ * index: index of the job in job file order
+ *
+ * output: stream to write to
+ */
+static void write_job(Job* job, int index, FILE* output);
+
+/*
+ * Reports the throughput of the batch and every job that took more than
+ * STRAGGLER_FACTOR times the median job to stderr
+ *
+ * batch: batch that finished
+ *
+ * time: microseconds the whole batch took
+ */
+static void report(Batch* batch, long long time);
+
+/*
+ * Compares 2 job times for qsort()
+ */
+static int compare_times(const void* first, const void* second);
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int main(int argc, char** argv) {
+    Batch batch;
+    FILE* output = stdout;
+    char* defaultPath = find_austerity(argv[0]);
+
+    memset(&batch, 0, sizeof(Batch));
+    batch.austerity = defaultPath;
+    int optionEnd = process_options(argc, argv, &batch);
+    if (optionEnd == INVALID ||
+            !is_num_args_valid(argc - optionEnd, MIN_ARGS, MAX_ARGS)) {
+        fprintf(stderr, "Usage: batch [-j workers] [-t timeout] "
+                "[-a austerity] [-H] jobs [output]\n");
+        return WRONG_NUM_ARGS;
+    }
+
+    if (!read_jobs(argv[optionEnd], &batch)) {
+        fprintf(stderr, "Cannot read job file\n");
+        free_batch(&batch);
+        free(defaultPath);
+        return CANNOT_OPEN_JOBS;
+    }
+    if (optionEnd + 1 < argc &&
+            (output = fopen(argv[optionEnd + 1], "w")) == NULL) {
+        fprintf(stderr, "Cannot write output file\n");
+        free_batch(&batch);
+        free(defaultPath);
+        return CANNOT_WRITE_OUTPUT;
+    }
+    if (batch.workers > batch.count) { // idle workers would only steal
+        batch.workers = batch.count;
+    }
+
+    long long start = time_now_us();
+    if (!start_workers(&batch)) {
+        fprintf(stderr, "Cannot start workers\n");
+        exit(CANNOT_RUN_JOBS); // workers may still be running
+    }
+    for (int index = 0; index < batch.count; index++) { // in job order
+        write_job(wait_for_job(&batch, index), index, output);
+    }
+    fflush(output);
+    report(&batch, time_now_us() - start);
+
+    if (output != stdout) {
+        fclose(output);
+    }
+    free_batch(&batch);
+    free(defaultPath);
+    return 0;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int process_options(int argc, char** argv, Batch* batch) {
+    int option;
+
+    batch->workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (batch->workers < 1) {
+        batch->workers = 1;
+    }
+    batch->timeout = 0;
+    batch->headless = false;
+
+    opterr = 0;
+    while ((option = getopt(argc, argv, OPTIONS)) != INVALID) {
+        switch (option) {
+            case 'j':
+                batch->workers = is_str_pos_number(optarg);
+                if (batch->workers < 1) {
+                    return INVALID;
+                }
+                break;
+            case 't':
+                batch->timeout = is_str_pos_number(optarg);
+                if (batch->timeout < 1) {
+                    return INVALID;
+                }
+                break;
+            case 'a':
+                batch->austerity = optarg;
+                break;
+            case 'H':
+                batch->headless = true;
+                break;
+            default: // unknown option or missing value
+                return INVALID;
+        }
+    }
+    return optind;
+}
+
+//
+static char* find_austerity(char* program) {
+    char* separator = strrchr(program, '/');
+    int directory = (separator == NULL) ? 0 : separator - program + 1;
+    // room for a leading ./ when there is no directory
+    char* path = malloc(directory + strlen(AUSTERITY_NAME) + 3);
+
+    if (path != NULL) {
+        if (directory == 0) { // run from the path so austerity is too
+            sprintf(path, "./%s", AUSTERITY_NAME);
+        } else {
+            sprintf(path, "%.*s%s", directory, program, AUSTERITY_NAME);
+        }
+    }
+    return path;
+}
+
+//
+static void write_job(Job* job, int index, FILE* output) {
+    fprintf(output, "== job %d: %s\n", index + 1, job->line);
+    fwrite(job->output, 1, job->length, output);
+    if (job->length > 0 && job->output[job->length - 1] != '\n') {
+        fputc('\n', output);
+    }
+    switch (job->status) {
+        case JOB_TIMED_OUT:
+            fprintf(output, "== job %d timed out\n", index + 1);
+            break;
+        case JOB_SIGNALED:
+            fprintf(output, "== job %d killed by signal %d\n", index + 1,
+                    job->signal);
+            break;
+        case JOB_NOT_STARTED:
+            fprintf(output, "== job %d could not be started\n", index + 1);
+            break;
+        default:
+            fprintf(output, "== job %d exited with status %d\n", index + 1,
+                    job->status);
+    }
+}
+
+//
+static void report(Batch* batch, long long time) {
+    long long* times = malloc(sizeof(long long) * batch->count);
+    long long busy = 0;
+
+    fprintf(stderr, "Ran %d jobs on %d workers in %lldus (%.1f jobs/s, "
+            "%d stolen)\n",
+            batch->count,
+            batch->workers,
+            time,
+            (double)batch->count * US_PER_SEC / (time > 0 ? time : 1),
+            batch->steals);
+    if (times == NULL) {
+        return;
+    }
+    for (int index = 0; index < batch->count; index++) {
+        times[index] = batch->jobs[index].time;
+        busy += times[index];
+    }
+    qsort(times, batch->count, sizeof(long long), compare_times);
+    long long median = times[batch->count / 2];
+    fprintf(stderr, "Jobs took %lldus on average, median %lldus, longest "
+            "%lldus\n",
+            busy / batch->count,
+            median,
+            times[batch->count - 1]);
+    for (int index = 0; index < batch->count; index++) {
+        long long took = batch->jobs[index].time;
+        if (took > STRAGGLER_FACTOR * median && took > STRAGGLER_MIN) {
+            fprintf(stderr, "Straggler job %d took %lldus: %s\n", index + 1,
+                    took, batch->jobs[index].line);
+        }
+    }
+    free(times);
+}
+
+//
+static int compare_times(const void* first, const void* second) {
+    long long a = *(const long long*)first;
+    long long b = *(const long long*)second;
+
+    return (a > b) - (a < b);
+}
@@ -0,0 +1,298 @@
+/* benchCosts.c
+ *
+ * Author: Michael Bossner
+ *
+ * benchCosts.c is the main file for the cost kernel benchmark. It times the
+ * kernels of costs.c against the plain loops over the cards they replaced
+ * on boards of different sizes and checks both give the same answers.
+ *
+ * Usage: benchCosts [rounds]
+ *
+ * affordable_markets() is timed against can_afford() on every market,
+ * wild_needed() against the wild worked out by load_tokens() and
+ * total_costs() against the card_cost_count() loop the strategies used.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "costs.h"
+#include "afford.h"
+#include "moves.h"
+#include "board.h"
+#include "deckFile.h"
+#include "lib.h"
+#include "endAusterity.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define MAX_ARGS 2
+#define ARGV_ROUNDS 1
+#define DEFAULT_DECK "deck"
+#define DEFAULT_ROUNDS 200000
+#define PLAYERS 4
+#define MOST_TOKENS 6
+#define MOST_DISCOUNTS 4
+#define MOST_WILD 5
+#define WILD_TOKENS MAX_TOKEN_COLOUR
+#define NS_PER_US 1000.0
+#define BENCH_FAILED 1
+
+#if defined(__AVX2__)
+#define KERNELS "AVX2"
+#elif defined(__SSE2__)
+#define KERNELS "SSE2"
+#else
+#define KERNELS "plain loop"
+#endif
+
+/* Kernels that work out one answer for every market on the board */
+enum Kernel {
+    AFFORDABLE,
+    WILD_NEEDED,
+    TOTAL_COSTS,
+    KERNEL_COUNT,
+};
+
+/* Answers of a kernel for every market on the board */
+typedef struct {
+    unsigned long long mask; // markets that can be afforded
+    int values[MAX_MARKETS]; // wild needed or total cost of each market
+} Answers;
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Sets up a board of markets from the deck and gives every player some
+ * tokens, discounts and wild tokens so some markets can be afforded
+ *
+ * state: state to set up
+ *
+ * deck: deck the markets are filled from
+ *
+ * markets: number of markets
+ */
+static void set_up(GameState* state, Deck* deck, int markets);
+
+/*
+ * Runs a kernel of costs.c for a player
+ *
+ * state: state of the game
+ *
+ * kernel: kernel to run. See Kernel enum
+ *
+ * player: player buying
+ *
+ * answers: storage for the answers. Must be zeroed
+ */
+static void run_packed(GameState* state, int kernel, int player,
+        Answers* answers);
+
+/*
+ * Works out the same answers as run_packed() one card at a time
+ *
+ * state: state of the game
+ *
+ * kernel: kernel to copy. See Kernel enum
+ *
+ * player: player buying
+ *
+ * answers: storage for the answers. Must be zeroed
+ */
+static void run_plain(GameState* state, int kernel, int player,
+        Answers* answers);
+
+/*
+ * Counts the total cost of a card after discounts the way the strategies
+ * did before total_costs()
+ *
+ * state: state of the game
+ *
+ * player: player buying
+ *
+ * card: card to count
+ *
+ * return: returns the total cost
+ */
+static long card_cost_count(GameState* state, int player, Card* card);
+
+/*
+ * Times a way of running a kernel for every player over many rounds
+ *
+ * state: state of the game
+ *
+ * kernel: kernel to time
+ *
+ * run: run_packed() or run_plain()
+ *
+ * rounds: number of times each player is run
+ *
+ * return: returns the nanoseconds each run took on average
+ */
+static double time_kernel(GameState* state, int kernel,
+        void (*run)(GameState*, int, int, Answers*), int rounds);
+
+////////////////////////////// Global Variables ///////////////////////////////
+
+/* State of the game being timed. Too big to keep on the stack */
+static GameState bench;
+
+/* Names of each kernel */
+static const char* kernelNames[KERNEL_COUNT] = {
+    "affordable_markets",
+    "wild_needed",
+    "total_costs",
+};
+
+/* Answers are added into this so the work can not be left out */
+static volatile long sink;
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int main(int argc, char** argv) {
+    const int boards[] = {DEFAULT_MARKETS, 16, MAX_MARKETS};
+    int rounds = DEFAULT_ROUNDS;
+    Deck deck;
+
+#ifdef __AVX2__
+    if (!__builtin_cpu_supports("avx2")) {
+        printf("AVX2 kernels skipped. This machine does not have AVX2\n");
+        return 0;
+    }
+#endif
+    if (!is_num_args_valid(argc, 1, MAX_ARGS) || (argc == MAX_ARGS &&
+            (rounds = is_str_pos_number(argv[ARGV_ROUNDS])) < 1)) {
+        fprintf(stderr, "Usage: benchCosts [rounds]\n");
+        return WRONG_NUM_ARGS;
+    } else if (open_deck(DEFAULT_DECK, &deck, true) != VALID) {
+        fprintf(stderr, "Cannot read deck file\n");
+        return INVALID_DECK;
+    }
+
+    printf("%s kernels, %d rounds of %d players\n", KERNELS, rounds,
+            PLAYERS);
+    printf("%-20s %8s %12s %12s %8s\n", "kernel", "markets", "packed ns",
+            "plain ns", "speedup");
+    for (size_t board = 0; board < sizeof(boards) / sizeof(int); board++) {
+        set_up(&bench, &deck, boards[board]);
+        for (int kernel = 0; kernel < KERNEL_COUNT; kernel++) {
+            for (int player = 0; player < PLAYERS; player++) {
+                Answers packed = {0};
+                Answers plain = {0};
+
+                run_packed(&bench, kernel, player, &packed);
+                run_plain(&bench, kernel, player, &plain);
+                if (memcmp(&packed, &plain, sizeof(Answers)) != 0) {
+                    fprintf(stderr, "%s differs from the plain loop\n",
+                            kernelNames[kernel]);
+                    close_deck(&deck);
+                    return BENCH_FAILED;
+                }
+            }
+            double packedTime = time_kernel(&bench, kernel, run_packed,
+                    rounds);
+            double plainTime = time_kernel(&bench, kernel, run_plain,
+                    rounds);
+            printf("%-20s %8d %12.1f %12.1f %7.2fx\n", kernelNames[kernel],
+                    boards[board], packedTime, plainTime,
+                    plainTime / packedTime);
+        }
+    }
+    close_deck(&deck);
+    return 0;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void set_up(GameState* state, Deck* deck, int markets) {
+    memset(state, 0, sizeof(GameState));
+    state->player.count = PLAYERS;
+    state->board.size = markets;
+    init_board(state);
+    for (int player = 0; player < PLAYERS; player++) {
+        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+            state->player.tokens[player][colour] =
+                    (player + colour) % (MOST_TOKENS + 1);
+            state->player.discountList[player][colour] =
+                    (player * colour) % (MOST_DISCOUNTS + 1);
+        }
+        state->player.wildPile[player] = player % (MOST_WILD + 1);
+    }
+    for (int market = 0; market < markets; market++) {
+        add_to_board(state, &deck->cards[market % deck->size]);
+    }
+}
+
+//
+static void run_packed(GameState* state, int kernel, int player,
+        Answers* answers) {
+    switch (kernel) {
+        case AFFORDABLE:
+            answers->mask = affordable_markets(state, player);
+            break;
+        case WILD_NEEDED:
+            wild_needed(state, player, answers->values);
+            break;
+        case TOTAL_COSTS:
+            total_costs(state, player, answers->values);
+            break;
+    }
+}
+
+//
+static void run_plain(GameState* state, int kernel, int player,
+        Answers* answers) {
+    long payment[MAX_TOKEN_COLOUR + 1];
+
+    for (int market = 0; market < market_count(state); market++) {
+        Card* card = check_market_card(state, market);
+        switch (kernel) {
+            case AFFORDABLE:
+                answers->mask |= (unsigned long long)can_afford(state,
+                        player, card) << market;
+                break;
+            case WILD_NEEDED: // load_tokens() pays this way
+                pay_for_market(state, player, market, payment);
+                answers->values[market] = payment[WILD_TOKENS];
+                break;
+            case TOTAL_COSTS:
+                answers->values[market] = card_cost_count(state, player,
+                        card);
+                break;
+        }
+    }
+}
+
+//
+static long card_cost_count(GameState* state, int player, Card* card) {
+    long count = 0;
+
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        count += card->cost[colour];
+        if (card->cost[colour] > 0) {
+            count -= state->player.discountList[player][colour];
+            if (count < 0) {
+                count = 0;
+            }
+        }
+    }
+    return count;
+}
+
+//
+static double time_kernel(GameState* state, int kernel,
+        void (*run)(GameState*, int, int, Answers*), int rounds) {
+    Answers answers = {0};
+    long long start = time_now_us();
+
+    for (int round = 0; round < rounds; round++) {
+        for (int player = 0; player < PLAYERS; player++) {
+            answers.mask = 0;
+            run(state, kernel, player, &answers);
+            sink += answers.mask + answers.values[market_count(state) - 1];
+        }
+    }
+    return (time_now_us() - start) * NS_PER_US / ((double)rounds * PLAYERS);
+}
@@ -0,0 +1,447 @@
+/* benchWire.c
+ *
+ * Author: Michael Bossner
+ *
+ * benchWire.c is the main file for the wire protocol benchmark. It plays
+ * games of random legal moves, writes everything the hub would send a
+ * player as text and as records and times how long a player takes to read
+ * and parse each form.
+ *
+ * Usage: benchWire [rounds]
+ *
+ * Text is read with read_line() and parsed with the parsers the players
+ * use. Records are read with read_record() and unpacked with
+ * decode_record(). Both must give back every message that was sent. The
+ * bytes each form takes per turn are printed with the times.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "wire.h"
+#include "comms.h"
+#include "card.h"
+#include "moves.h"
+#include "rules.h"
+#include "board.h"
+#include "token.h"
+#include "deckFile.h"
+#include "lib.h"
+#include "endAusterity.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define MAX_ARGS 2
+#define ARGV_ROUNDS 1
+#define DEFAULT_DECK "deck"
+#define DEFAULT_ROUNDS 2000
+#define GAMES 20
+#define TURNS 200
+#define PLAYERS 4
+#define TOKENS 7
+#define MESSAGE_BUFFER 128
+#define NS_PER_US 1000.0
+#define BENCH_FAILED 1
+
+/* Start of each text message and where what follows it starts */
+#define PURCHASED_START 9
+#define NEWCARD_START 7
+#define TOOK_START 4
+#define TOKENS_START 6
+#define WILD_START 4
+#define MARKETS_START 7
+#define PLAYER_FIELD 2 // "A:" before the fields of purchased and took
+
+/* Everything the hub sends one player over a run of games */
+typedef struct {
+    Record* records; // every message in the order it was sent
+    int count; // number of messages
+    int turns; // turns played in every game
+    char* text; // messages as text lines
+    long textBytes; // bytes of text
+    char* packed; // messages as records
+    long packedBytes; // bytes of records
+} Stream;
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Plays games of random legal moves and keeps every message the hub would
+ * send the first player in both forms
+ *
+ * stream: storage for the messages
+ *
+ * deck: deck the markets are filled from. Cards are reused once it runs out
+ *
+ * return: returns false if memory could not be allocated else true
+ */
+static bool play_games(Stream* stream, Deck* deck);
+
+/*
+ * Adds a message to a stream in both forms
+ *
+ * stream: stream to add to
+ *
+ * record: message to add
+ *
+ * return: returns false if memory could not be allocated else true
+ */
+static bool send(Stream* stream, Record* record);
+
+/*
+ * Parses a text message the way the players do
+ *
+ * line: message without its newline
+ *
+ * record: storage for the message
+ *
+ * return: returns false if the message is not valid else true
+ */
+static bool parse_text(char* line, Record* record);
+
+/*
+ * Reads every message of a file of text lines and parses each one
+ *
+ * fd: file holding the messages
+ *
+ * records: storage for the messages read. NULL to throw them away
+ *
+ * return: returns the number of messages read or -1 if one is not valid
+ */
+static int read_text(int fd, Record* records);
+
+/*
+ * Reads every message of a file of records and unpacks each one
+ *
+ * fd: file holding the messages
+ *
+ * records: storage for the messages read. NULL to throw them away
+ *
+ * return: returns the number of messages read or -1 if one is not valid
+ */
+static int read_packed(int fd, Record* records);
+
+/*
+ * Checks two lists of messages hold the same messages
+ *
+ * first: first list
+ *
+ * second: second list
+ *
+ * count: number of messages in each list
+ *
+ * return: returns true if every message is the same else false
+ */
+static bool same_records(Record* first, Record* second, int count);
+
+/*
+ * Writes some bytes into a new temporary file
+ *
+ * bytes: bytes to write
+ *
+ * length: number of bytes
+ *
+ * return: returns the file descriptor of the file or -1 if it could not be
+ *         written
+ */
+static int write_file(char* bytes, long length);
+
+/*
+ * Times reading a file of messages many times over
+ *
+ * fd: file holding the messages
+ *
+ * reader: read_text() or read_packed()
+ *
+ * rounds: number of times the file is read
+ *
+ * count: number of messages in the file
+ *
+ * return: returns the nanoseconds each message took on average
+ */
+static double time_reads(int fd, int (*reader)(int, Record*), int rounds,
+        int count);
+
+////////////////////////////// Global Variables ///////////////////////////////
+
+/* State of the games played. Too big to keep on the stack */
+static GameState bench;
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int main(int argc, char** argv) {
+    Stream stream = {0};
+    int rounds = DEFAULT_ROUNDS;
+    Deck deck;
+
+    if (!is_num_args_valid(argc, 1, MAX_ARGS) || (argc == MAX_ARGS &&
+            (rounds = is_str_pos_number(argv[ARGV_ROUNDS])) < 1)) {
+        fprintf(stderr, "Usage: benchWire [rounds]\n");
+        return WRONG_NUM_ARGS;
+    } else if (open_deck(DEFAULT_DECK, &deck, true) != VALID) {
+        fprintf(stderr, "Cannot read deck file\n");
+        return INVALID_DECK;
+    }
+    bool played = play_games(&stream, &deck);
+    close_deck(&deck);
+    int textFd = played ?
+            write_file(stream.text, stream.textBytes) : INVALID;
+    int packedFd = played ?
+            write_file(stream.packed, stream.packedBytes) : INVALID;
+    Record* check = malloc(sizeof(Record) * stream.count);
+    if (textFd == INVALID || packedFd == INVALID || check == NULL) {
+        fprintf(stderr, "Cannot set up the messages\n");
+        return BENCH_FAILED;
+    }
+
+    if (read_text(textFd, check) != stream.count ||
+            !same_records(check, stream.records, stream.count)) {
+        fprintf(stderr, "Text does not give back the messages sent\n");
+        return BENCH_FAILED;
+    } else if (read_packed(packedFd, check) != stream.count ||
+            !same_records(check, stream.records, stream.count)) {
+        fprintf(stderr, "Records do not give back the messages sent\n");
+        return BENCH_FAILED;
+    }
+
+    double textTime = time_reads(textFd, read_text, rounds, stream.count);
+    double packedTime = time_reads(packedFd, read_packed, rounds,
+            stream.count);
+    printf("%d messages over %d turns of %d games, %d rounds\n",
+            stream.count, stream.turns, GAMES, rounds);
+    printf("%-8s %12s %16s %14s\n", "form", "bytes", "bytes per turn",
+            "ns per message");
+    printf("%-8s %12ld %16.1f %14.1f\n", "text", stream.textBytes,
+            (double)stream.textBytes / stream.turns, textTime);
+    printf("%-8s %12ld %16.1f %14.1f\n", "binary", stream.packedBytes,
+            (double)stream.packedBytes / stream.turns, packedTime);
+
+    close(textFd);
+    close(packedFd);
+    free(check);
+    free(stream.records);
+    free(stream.text);
+    free(stream.packed);
+    return 0;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static bool play_games(Stream* stream, Deck* deck) {
+    Action moves[MAX_MOVES];
+    Record record;
+    Card bought;
+    bool sent = true;
+
+    srand(0);
+    for (int game = 0; game < GAMES && sent; game++) {
+        memset(&bench, 0, sizeof(GameState));
+        bench.player.count = PLAYERS;
+        bench.board.size = DEFAULT_MARKETS;
+        bench.tokenPile.maxTokens = TOKENS;
+        init_board(&bench);
+        init_tokens(&bench);
+        if (game > 0) {
+            sent &= send(stream, &(Record){.type = WIRE_NEWGAME});
+        }
+        sent &= send(stream, &(Record){.type = WIRE_TOKENS,
+                .values = {TOKENS}});
+        sent &= send(stream, &(Record){.type = WIRE_MARKETS,
+                .values = {DEFAULT_MARKETS}});
+        for (int market = 0; market < DEFAULT_MARKETS; market++) {
+            Card* card = &deck->cards[deck->deckIndex++ % deck->size];
+            add_to_board(&bench, card);
+            card_to_record(&record, card);
+            sent &= send(stream, &record);
+        }
+
+        for (int turn = 0; turn < TURNS && sent; turn++) {
+            int player = turn % PLAYERS;
+            int count = legal_moves(&bench, player, moves);
+            Action* move = &moves[rand() % count];
+
+            if (player == 0) { // only the first player is asked here
+                sent &= send(stream, &(Record){.type = WIRE_DOWHAT});
+            }
+            apply_action(&bench, player, move, &bought);
+            action_to_record(&record, player, move);
+            sent &= send(stream, &record);
+            if (move->type == ACTION_PURCHASE) {
+                Card* card = &deck->cards[deck->deckIndex++ % deck->size];
+                add_to_board(&bench, card);
+                card_to_record(&record, card);
+                sent &= send(stream, &record);
+            }
+            stream->turns++;
+        }
+    }
+    return sent && send(stream, &(Record){.type = WIRE_EOG});
+}
+
+//
+static bool send(Stream* stream, Record* record) {
+    if (stream->count % READ_BUFFER == 0) { // room for READ_BUFFER more
+        int more = stream->count + READ_BUFFER;
+        Record* records = realloc(stream->records, sizeof(Record) * more);
+        char* text = realloc(stream->text, (long)MESSAGE_BUFFER * more);
+        char* packed = realloc(stream->packed, (long)MAX_RECORD * more);
+
+        stream->records = (records != NULL) ? records : stream->records;
+        stream->text = (text != NULL) ? text : stream->text;
+        stream->packed = (packed != NULL) ? packed : stream->packed;
+        if (records == NULL || text == NULL || packed == NULL) {
+            return false;
+        }
+    }
+    stream->records[stream->count++] = *record;
+    stream->textBytes += format_record(record,
+            &stream->text[stream->textBytes], MESSAGE_BUFFER);
+    stream->packedBytes += encode_record(record,
+            &stream->packed[stream->packedBytes]);
+    return true;
+}
+
+//
+static bool parse_text(char* line, Record* record) {
+    Action action = {.type = ACTION_INVALID};
+    Card card;
+
+    memset(record, 0, sizeof(Record));
+    if (strcmp(line, "eog") == 0) {
+        record->type = WIRE_EOG;
+    } else if (strcmp(line, "dowhat") == 0) {
+        record->type = WIRE_DOWHAT;
+    } else if (strcmp(line, "newgame") == 0) {
+        record->type = WIRE_NEWGAME;
+    } else if (strncmp(line, "purchased", PURCHASED_START) == 0) {
+        action.type = ACTION_PURCHASE;
+        line = &line[PURCHASED_START];
+        if (line[1] != ':' || !is_valid_purchase(action.tokens,
+                &line[PLAYER_FIELD], &action.boardIndex)) {
+            return false;
+        }
+    } else if (strncmp(line, "newcard", NEWCARD_START) == 0) {
+        if (!unwrap_card(&line[NEWCARD_START], &card)) {
+            return false;
+        }
+        card_to_record(record, &card);
+    } else if (strncmp(line, "took", TOOK_START) == 0) {
+        action.type = ACTION_TAKE;
+        line = &line[TOOK_START];
+        if (line[1] != ':' ||
+                !is_valid_take(action.tokens, &line[PLAYER_FIELD])) {
+            return false;
+        }
+    } else if (strncmp(line, "tokens", TOKENS_START) == 0) {
+        record->type = WIRE_TOKENS;
+        record->values[0] = is_str_pos_number(&line[TOKENS_START]);
+    } else if (strncmp(line, "markets", MARKETS_START) == 0) {
+        record->type = WIRE_MARKETS;
+        record->values[0] = is_str_pos_number(&line[MARKETS_START]);
+    } else if (strncmp(line, "wild", WILD_START) == 0) {
+        action.type = ACTION_WILD;
+        line = &line[WILD_START];
+    } else {
+        return false;
+    }
+    if (action.type != ACTION_INVALID) {
+        action_to_record(record, player_char_to_int(line[0]), &action);
+    }
+    return true;
+}
+
+//
+static int read_text(int fd, Record* records) {
+    Reader reader;
+    Record record;
+    char* line;
+    int streamEnd;
+    int count = 0;
+
+    if (lseek(fd, 0, SEEK_SET) != 0 || !open_reader(&reader, fd, NULL)) {
+        return INVALID;
+    }
+    while ((line = read_line(&reader, NULL, &streamEnd)) != NULL) {
+        if (streamEnd || !parse_text(line, &record)) {
+            count = INVALID;
+            break;
+        } else if (records != NULL) {
+            records[count] = record;
+        }
+        count++;
+    }
+    close_reader(&reader);
+    return count;
+}
+
+//
+static int read_packed(int fd, Record* records) {
+    Reader reader;
+    Record record;
+    char* packed;
+    int streamEnd;
+    int count = 0;
+
+    if (lseek(fd, 0, SEEK_SET) != 0 || !open_reader(&reader, fd, NULL)) {
+        return INVALID;
+    }
+    while ((packed = read_record(&reader, &streamEnd)) != NULL) {
+        if (streamEnd || !decode_record(packed, &record)) {
+            count = INVALID;
+            break;
+        } else if (records != NULL) {
+            records[count] = record;
+        }
+        count++;
+    }
+    close_reader(&reader);
+    return count;
+}
+
+//
+static bool same_records(Record* first, Record* second, int count) {
+    for (int index = 0; index < count; index++) {
+        Record* a = &first[index];
+        Record* b = &second[index];
+        if (a->type != b->type || a->player != b->player ||
+                a->market != b->market || a->discount != b->discount ||
+                memcmp(a->values, b->values, sizeof(a->values)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//
+static int write_file(char* bytes, long length) {
+    FILE* file = tmpfile();
+    int fd;
+
+    if (file == NULL) {
+        return INVALID;
+    }
+    fd = dup(fileno(file));
+    if (fwrite(bytes, 1, length, file) != (size_t)length ||
+            fflush(file) != 0) {
+        close(fd);
+        fd = INVALID;
+    }
+    fclose(file);
+    return fd;
+}
+
+//
+static double time_reads(int fd, int (*reader)(int, Record*), int rounds,
+        int count) {
+    long long start = time_now_us();
+
+    for (int round = 0; round < rounds; round++) {
+        if (reader(fd, NULL) != count) {
+            return 0;
+        }
+    }
+    return (time_now_us() - start) * NS_PER_US / ((double)rounds * count);
+}
@@ -8,33 +8,26 @@
 
 #include <stdio.h>
 #include <stdbool.h>
-#include <stdlib.h>
+#include <string.h>
 
 #include "board.h"
 #include "deck.h"
 #include "lib.h"
 #include "card.h"
-
-//////////////////////// Private Functions Prototypes /////////////////////////
-
-/*
- * Checks how many markets are set up on the board
- *
- * state: Contains all information needed to keep track of the game
- *
- * return: returns the number of markets set up on the board
- */
-static int market_length(GameState* state);
+#include "afford.h"
+#include "costs.h"
 
 ////////////////////////////////// Functions //////////////////////////////////
 
 void init_board(GameState* state) {
-    state->board.oldest = NULL;
-    state->board.youngest = NULL;
+    state->board.count = 0;
+    state->board.wideCards = 0;
+    memset(state->board.costs, 0, sizeof(state->board.costs));
+    clear_affordable(state);
 }
 
 bool is_board_empty(GameState* state) {
-    if (state->board.oldest == NULL) {
+    if (state->board.count == 0) {
         return true;
     } else {
         return false;
@@ -42,77 +35,43 @@ bool is_board_empty(GameState* state) {
 }
 
 void free_board(GameState* state) {
-    Market* temp;
-    while (!is_board_empty(state)) {
-        temp = state->board.oldest->next;
-        free(state->board.oldest);
-        state->board.oldest = temp;
-    }
+    init_board(state);
 }
 
-Card* purchase_card(GameState* state, int boardIndex) {
-    Card* purchasedCard;
-    if (boardIndex >= 0 && boardIndex < market_length(state)) {
-        Market* temp = state->board.oldest;
-        if (boardIndex == 0) { // card is the oldest card
-            if (market_length(state) == 1) { // only 1 card on the board
-                state->board.oldest = NULL;
-                state->board.youngest = NULL;
-            } else { // more than 1 card on the board
-                temp->next->prev = NULL;
-                state->board.oldest = temp->next;
-            }
-        } else if (boardIndex == market_length(state) - 1) {
-            // card is the youngest card
-            temp = state->board.youngest;
-            temp->prev->next = NULL;
-            state->board.youngest = temp->prev;
-        } else { // card is a middle card
-            for (int i = 0; i <= boardIndex; i++) {             
-                if (i == boardIndex) {                  
-                    temp->prev->next = temp->next;
-                    temp->next->prev = temp->prev;
-                } else {
-                    temp = temp->next;
-                }
-            }
+int purchase_card(GameState* state, int boardIndex, Card* card) {
+    Board* board = &state->board;
+
+    if (boardIndex >= 0 && boardIndex < board->count) {
+        if (card != NULL) {
+            *card = board->markets[boardIndex];
         }
-        purchasedCard = temp->card;
-        free(temp);
-        return purchasedCard;
+        unpack_costs(state, boardIndex);
+        // younger markets move left to fill the gap
+        memmove(&board->markets[boardIndex], &board->markets[boardIndex + 1],
+                sizeof(Card) * (board->count - boardIndex - 1));
+        board->count--;
+        remove_affordable(state, boardIndex);
+        return VALID;
     } else {
-        return NULL;
+        return FAIL;
     }
 }
 
 void print_board(GameState* state, FILE* stream) {
-    int cardCount = 0;
-    Market* temp = state->board.oldest;
-    while (temp != NULL) {
+    for (int cardCount = 0; cardCount < state->board.count; cardCount++) {
         fprintf(stream, "Card %d:", cardCount);
         fflush(stream);
-        print_card(temp->card, stream);
-        temp = temp->next;
-        cardCount++;
+        print_card(&state->board.markets[cardCount], stream);
     }
 }
 
 int add_to_board(GameState* state, Card* card) {
-    if ((state->deck.deckIndex < state->deck.size) && 
-            (market_length(state) < MAX_MARKETS)) { 
+    if ((card != NULL) && (state->board.count < state->board.size)) { 
         // card available && market spot available
-        Market* market = malloc(sizeof(Market) * 1);
-        market->card = card;
-        if (is_board_empty(state)) { // board is empty
-            state->board.oldest = market;
-            state->board.youngest = market;
-            market->prev = NULL;
-        } else { // board is not empty but not full
-            market->prev = state->board.youngest;
-            state->board.youngest->next = market;
-            state->board.youngest = market;
-        }
-        market->next = NULL;
+        state->board.markets[state->board.count] = *card;
+        state->board.count++;
+        pack_costs(state, state->board.count - 1);
+        add_affordable(state, state->board.count - 1);
         return VALID;
     } else {
         return FAIL;
@@ -120,26 +79,13 @@ int add_to_board(GameState* state, Card* card) {
 }
 
 Card* check_market_card(GameState* state, int boardIndex) {
-    Market* temp = state->board.oldest;
-    while (temp != NULL) {
-        if (!boardIndex) {
-            return temp->card;
-        } else {
-            temp = temp->next;
-            boardIndex--;
-        }
+    if (boardIndex >= 0 && boardIndex < state->board.count) {
+        return &state->board.markets[boardIndex];
+    } else {
+        return NULL;
     }
-    return NULL;
 }
 
-////////////////////////////// Private Functions //////////////////////////////
-//
-static int market_length(GameState* state) {
-    int count = 0;
-    Market* temp = state->board.oldest;
-    while (temp != NULL) {
-        count++;
-        temp = temp->next;
-    }
-    return count;
-}
\ No newline at end of file
+int market_count(GameState* state) {
+    return state->board.count;
+}
@@ -10,14 +10,10 @@
 
 #include "lib.h"
 
-/////////////////////////////////// Defines ///////////////////////////////////
-
-#define MAX_MARKETS 8
-
 ///////////////////////// Public Function Prototypes //////////////////////////
 
 /*
- * Sets up the board to be empty
+ * Sets up the board to be empty. The size of the board is not changed
  *
  * state: Contains all information needed to keep track of the game
  */
@@ -33,27 +29,26 @@ void init_board(GameState* state);
 bool is_board_empty(GameState* state);
 
 /*
- * Frees all markets set up on the board from memory. Does not free the
- * cards contained in the market.
+ * Removes all markets set up on the board
  *
  * state: Contains all information needed to keep track of the game
  */
 void free_board(GameState* state);
 
 /*
- * Removes a market from the board and frees it from memory. The card contained
- * in the market is returned for use.
- *
+ * Removes a market from the board. Younger markets move down one index to
+ * fill the gap. The card contained in the market is copied out for use.
  *
  * state: Contains all information needed to keep track of the game
  *
  * boardIndex: Index of the market to be removed and card collected
  *
- * return: If there is a market set up at the boardIndex the card contained
- *         is returned else if there is no market set up a NULL pointer
- *         is returned.
+ * card: storage for the card that was in the market. May be NULL
+ *
+ * return: Returns 0 if there is no market set up at the boardIndex else 
+ *         returns 1
  */
-Card* purchase_card(GameState* state, int boardIndex);
+int purchase_card(GameState* state, int boardIndex, Card* card);
 
 /*
  * prints all cards currently on the board in the format of 
@@ -74,11 +69,13 @@ void print_board(GameState* state, FILE* stream);
 
 /*
  * Sets up a market for the board if there is a card left in the deck to be 
- * sold && there is a free market spot. Adds the card to the new market.
+ * sold && there is a free market spot. Copies the card into the new market
+ * as the youngest market.
  *
  * state: Contains all information needed to keep track of the game
  *
- * card: card to be sold in the new market
+ * card: card to be sold in the new market. NULL if there are no cards left
+ *       in the deck
  *
  * return: Returns 0 if the there are no free market spots || there are no
  *         cards left in the deck to be sold else returns 1
@@ -87,7 +84,7 @@ int add_to_board(GameState* state, Card* card);
 
 /*
  * Returns a pointer to the card contained in the market without changing 
- * anything or removing anything from memory.
+ * anything. The pointer is only valid until the board next changes.
  *
  * state: Contains all information needed to keep track of the game
  *
@@ -99,4 +96,13 @@ int add_to_board(GameState* state, Card* card);
  */
 Card* check_market_card(GameState* state, int boardIndex);
 
+/*
+ * Counts the markets set up on the board
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * return: returns the number of markets set up on the board
+ */
+int market_count(GameState* state);
+
 #endif
\ No newline at end of file
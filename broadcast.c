@@ -0,0 +1,234 @@
+/* broadcast.c
+ *
+ * Author: Michael Bossner
+ *
+ * broadcast.c handles all messages the hub sends to the players
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "broadcast.h"
+#include "lib.h"
+#include "ring.h"
+#include "wire.h"
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Writes a formatted message to a player pipe. Short writes are continued
+ * until the whole message is written. Errors such as a player closing its
+ * pipe are ignored as the SIGCHLD and SIGPIPE handlers deal with them.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to write to
+ *
+ * message: message to write
+ *
+ * length: length of the message
+ */
+static void write_message(GameState* state, int player, const char* message,
+        int length);
+
+/*
+ * Queues a message in the outbox of a player. The outbox is written out 
+ * first if the message does not fit. Messages are written straight away
+ * when output is not coalesced.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to queue the message for
+ *
+ * message: message to queue
+ *
+ * length: length of the message
+ *
+ * return: returns 0 if the player has no pipe else returns 1
+ */
+static int queue_message(GameState* state, int player, const char* message,
+        int length);
+
+/*
+ * Formats a message into a buffer and counts the format in the traffic
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * buffer: storage for the message. Must be MESSAGE_BUFFER in size
+ *
+ * format: printf style format of the message
+ *
+ * args: arguments for the format
+ *
+ * return: returns the length of the message. Messages longer than the 
+ *         buffer are cut short
+ */
+static int format_message(GameState* state, char* buffer, const char* format,
+        va_list args);
+
+////////////////////////////////// Functions //////////////////////////////////
+
+void broadcast(GameState* state, Record* record) {
+    char message[MESSAGE_BUFFER];
+    char packed[MAX_RECORD];
+    int length = INVALID; // neither form has been made yet
+    int size = 0;
+
+    state->traffic.broadcasts++;
+    for (int player = 0; player < state->player.count; player++) {
+        int sent;
+        if (state->player.binary[player]) {
+            if (size == 0) {
+                size = encode_record(record, packed);
+                state->traffic.formats++;
+            }
+            sent = queue_message(state, player, packed, size);
+        } else {
+            if (length == INVALID) {
+                length = format_record(record, message, MESSAGE_BUFFER);
+                state->traffic.formats++;
+            }
+            sent = queue_message(state, player, message, length);
+        }
+        if (sent) {
+            state->traffic.copies++;
+        }
+    }
+}
+
+void send_record(GameState* state, int player, Record* record) {
+    char message[MESSAGE_BUFFER];
+    int length;
+
+    if (state->player.binary[player]) {
+        length = encode_record(record, message);
+    } else {
+        length = format_record(record, message, MESSAGE_BUFFER);
+    }
+    state->traffic.formats++;
+    queue_message(state, player, message, length);
+}
+
+void send_player(GameState* state, int player, const char* format, ...) {
+    char message[MESSAGE_BUFFER];
+    va_list args;
+
+    va_start(args, format);
+    int length = format_message(state, message, format, args);
+    va_end(args);
+
+    queue_message(state, player, message, length);
+}
+
+void flush_player(GameState* state, int player) {
+    Outbox* outbox = &state->player.outboxes[player];
+
+    if (outbox->length > 0) {
+        write_message(state, player, outbox->buffer, outbox->length);
+        outbox->length = 0;
+    }
+    fflush(stdout);
+}
+
+void flush_players(GameState* state) {
+    for (int player = 0; player < state->player.count; player++) {
+        flush_player(state, player);
+    }
+}
+
+void flush_events(GameState* state) {
+    if (!state->config.coalesce) {
+        fflush(stdout);
+    }
+}
+
+void print_traffic(GameState* state) {
+    Traffic* traffic = &state->traffic;
+    long long perBroadcast = 0;
+
+    if (traffic->broadcasts > 0) {
+        perBroadcast = traffic->copies / traffic->broadcasts;
+    }
+    fprintf(stderr, "Hub sent %lld messages (%lld broadcasts) formatted %lld "
+            "times in %lld bytes and %lld writes (%lld copies per "
+            "broadcast)\n",
+            traffic->messages,
+            traffic->broadcasts,
+            traffic->formats,
+            traffic->bytes,
+            traffic->writes,
+            perBroadcast);
+    if (traffic->turns > 0) {
+        fprintf(stderr, "Hub played %lld turns sending %.1f bytes per turn\n",
+                traffic->turns, (double)traffic->bytes / traffic->turns);
+    }
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void write_message(GameState* state, int player, const char* message,
+        int length) {
+    int fd = fileno(state->player.commsList[player][WRITE]);
+    int written = 0;
+
+    if (state->player.rings[player][WRITE].ring != NULL) { // shm player
+        state->traffic.writes++;
+        if (ring_write(&state->player.rings[player][WRITE], message, 
+                length) == length) {
+            state->traffic.bytes += length;
+        }
+        return;
+    }
+    while (written < length) {
+        ssize_t result = write(fd, &message[written], length - written);
+        state->traffic.writes++;
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        written += result;
+        state->traffic.bytes += result;
+    }
+}
+
+//
+static int queue_message(GameState* state, int player, const char* message,
+        int length) {
+    Outbox* outbox = &state->player.outboxes[player];
+
+    if (state->player.commsList[player][WRITE] == NULL) { // no pipe
+        return 0;
+    }
+    state->traffic.messages++;
+    if (!state->config.coalesce) {
+        write_message(state, player, message, length);
+        return 1;
+    }
+    if (outbox->length + length > OUTBOX_BUFFER) {
+        write_message(state, player, outbox->buffer, outbox->length);
+        outbox->length = 0;
+    }
+    memcpy(&outbox->buffer[outbox->length], message, length);
+    outbox->length += length;
+    return 1;
+}
+
+//
+static int format_message(GameState* state, char* buffer, const char* format,
+        va_list args) {
+    int length = vsnprintf(buffer, MESSAGE_BUFFER, format, args);
+
+    state->traffic.formats++;
+    if (length < 0) {
+        buffer[0] = '\0';
+        return 0;
+    } else if (length >= MESSAGE_BUFFER) {
+        return MESSAGE_BUFFER - 1;
+    }
+    return length;
+}
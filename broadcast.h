@@ -0,0 +1,98 @@
+/* broadcast.h
+ *
+ * Author: Michael Bossner
+ *
+ * broadcast.h header file for broadcast.c
+ */
+
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include "lib.h"
+#include "wire.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define MESSAGE_BUFFER 128
+
+///////////////////////// Public Function Prototypes //////////////////////////
+
+/*
+ * Formats a message once as text and once as a record and writes it to the
+ * pipe of every player process in the protocol the player agreed to. Each
+ * form is only made if a player needs it. Plugin players and players that
+ * were never started have no pipe and are skipped. Each player gets the 
+ * whole message in a single write(). When output is coalesced the message
+ * is queued in the players outbox instead.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * record: message to send
+ */
+void broadcast(GameState* state, Record* record);
+
+/*
+ * Writes a message to the pipe of a single player process as text or as a
+ * record depending on the protocol the player agreed to. Nothing is sent if
+ * the player has no pipe. When output is coalesced the message is queued in
+ * the players outbox instead.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to send the message to
+ *
+ * record: message to send
+ */
+void send_record(GameState* state, int player, Record* record);
+
+/*
+ * Formats a text message and writes it to the pipe of a single player 
+ * process whatever protocol it uses. Only used before the protocol is 
+ * agreed. Nothing is sent if the player has no pipe. When output is 
+ * coalesced the message is queued in the players outbox instead.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to send the message to
+ *
+ * format: printf style format of the message
+ */
+void send_player(GameState* state, int player, const char* format, ...);
+
+/*
+ * Writes out all messages waiting for a player and flushes stdout. Does
+ * nothing to the player when output is not coalesced as messages were
+ * already written. A player only needs its messages before it is asked
+ * to reply so the hub calls this just before dowhat.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to write to
+ */
+void flush_player(GameState* state, int player);
+
+/*
+ * Writes out all messages waiting for every player and flushes stdout.
+ * Called before eog.
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+void flush_players(GameState* state);
+
+/*
+ * Called after the hub prints an event to stdout. stdout is flushed unless
+ * output is coalesced in which case it is left for flush_players().
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+void flush_events(GameState* state);
+
+/*
+ * Prints how many messages, bytes and write() calls the hub has sent to
+ * the players and the bytes sent for each turn played to stderr
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+void print_traffic(GameState* state);
+
+#endif
@@ -8,17 +8,33 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 #include "card.h"
 #include "lib.h"
 
 /////////////////////////////////// Defines ///////////////////////////////////
 
-#define MIN_CARD_LEN 11
 #define COLOUR 0
 #define POINTS 2
 #define BASE 10
 
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Reads a number made of only digits. Numbers too big for a long are 
+ * stored as LONG_MAX the same as strtol().
+ *
+ * text: place to read the number from. Moved past the number
+ *
+ * end: place after the last character that can be read
+ *
+ * number: storage for the number
+ *
+ * return: returns false if text does not start with a digit else true
+ */
+static bool parse_number(const char** text, const char* end, long* number);
+
 ////////////////////////////////// Functions //////////////////////////////////
 
 void print_card(Card* card, FILE* stream) {
@@ -33,41 +49,70 @@ void print_card(Card* card, FILE* stream) {
 }
 
 int unwrap_card(char* cardString, Card* card) {
-    char* index;
+    return parse_card(cardString, strlen(cardString), card);
+}
 
-    if (strlen(cardString) < MIN_CARD_LEN) { // not a valid card
-        return FAIL;
-    } else if ((cardString[COLOUR] != 'P' && cardString[COLOUR] != 'B' && 
-            cardString[COLOUR] != 'Y' && cardString[COLOUR] != 'R') || 
-            (cardString[1] != ':')) { // not a valid card
-        return FAIL;
-    } else {
-        card->discount = cardString[0];
-    }
+int parse_card(const char* text, int length, Card* card) {
+    const char* end = &text[length];
+    char separator = ':';
 
-    if (cardString[POINTS] < ZERO || cardString[POINTS] > NINE) { 
-        // needs to be a number
+    if (length < MIN_CARD_LEN) { // not a valid card
+        return FAIL;
+    } else if ((text[COLOUR] != 'P' && text[COLOUR] != 'B' && 
+            text[COLOUR] != 'Y' && text[COLOUR] != 'R') || 
+            (text[1] != ':')) { // not a valid card
         return FAIL;
-    } else {
-        card->points = strtol(&cardString[POINTS], &index, BASE);
     }
+    card->discount = text[COLOUR];
+    text = &text[POINTS];
 
-    if (index[0] != ':' && (index[1] < ZERO || index[1] > NINE)) {
+    if (!parse_number(&text, end, &card->points)) { // needs to be a number
         return FAIL;
-    } else {
-        card->cost[PURPLE] = strtol(&index[1], &index, BASE);
     }
-    for (int colour = BROWN; colour <= RED; colour++) {
-        if (index[0] != ',' && (index[1] < ZERO || index[1] > NINE)) {
+    for (int colour = PURPLE; colour <= RED; colour++) {
+        if (text == end || *text++ != separator || 
+                !parse_number(&text, end, &card->cost[colour])) {
             return FAIL;
-        } else {
-            card->cost[colour] = strtol(&index[1], &index, BASE);
         }
+        separator = ',';
     }
 
-    if (index[0] != '\0') { // there should not be anything else
+    if (text != end) { // there should not be anything else
         return FAIL;
     } else { // card is valid
         return VALID;
     }
-}
\ No newline at end of file
+}
+
+bool is_card_valid(Card* card) {
+    if ((card->discount != 'P' && card->discount != 'B' && 
+            card->discount != 'Y' && card->discount != 'R') || 
+            card->points < 0) {
+        return false;
+    }
+    for (int colour = PURPLE; colour <= RED; colour++) {
+        if (card->cost[colour] < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static bool parse_number(const char** text, const char* end, long* number) {
+    const char* digit = *text;
+    long value = 0;
+
+    if (digit == end || *digit < ZERO || *digit > NINE) {
+        return false;
+    }
+    for (; digit < end && *digit >= ZERO && *digit <= NINE; digit++) {
+        int next = *digit - ZERO;
+        value = (value > (LONG_MAX - next) / BASE) ? LONG_MAX : 
+                value * BASE + next;
+    }
+    *number = value;
+    *text = digit;
+    return true;
+}
@@ -10,6 +10,10 @@
 
 #include "lib.h"
 
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define MIN_CARD_LEN 11 // shortest a valid card can be. "B:0:0,0,0,0"
+
 ///////////////////////// Public Function Prototypes //////////////////////////
 
 /*
@@ -49,4 +53,30 @@ void print_card(Card* card, FILE* stream);
  */
 int unwrap_card(char* cardString, Card* card);
 
+/*
+ * The same as unwrap_card() but reads the card from the first length 
+ * characters of text, which does not need to be '\0' terminated. Used to 
+ * read cards straight out of a mapped deck file.
+ *
+ * text: string to be stored into the card
+ *
+ * length: number of characters in the card
+ *
+ * card: where the information from the string will be stored
+ *
+ * return: returns 0 if text is not of the correct format else returns 1
+ */
+int parse_card(const char* text, int length, Card* card);
+
+/*
+ * Checks a card holds only what parse_card() could have stored in it. Used
+ * on cards that were not parsed such as those of a compiled deck.
+ *
+ * card: card to check
+ *
+ * return: returns false if the discount is not a colour or the points or
+ *         a cost is negative else true
+ */
+bool is_card_valid(Card* card);
+
 #endif
\ No newline at end of file
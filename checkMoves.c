@@ -0,0 +1,314 @@
+/* checkMoves.c
+ *
+ * Author: Michael Bossner
+ *
+ * checkMoves.c is the main file for the move generator check. It plays
+ * games where every move is picked at random from legal_moves() and checks
+ * in each position that the moves listed are exactly the moves
+ * check_action() accepts.
+ *
+ * Usage: checkMoves [deck]
+ *
+ * Each game is played with a different number of players, markets and
+ * tokens so empty piles and full boards are both reached. Which markets
+ * can be bought is worked out again from the cards so a wrong mask of
+ * affordable markets can not pass. Any position where they disagree is
+ * printed and the check exits with 1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "moves.h"
+#include "rules.h"
+#include "deckFile.h"
+#include "board.h"
+#include "token.h"
+#include "lib.h"
+#include "endAusterity.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define MAX_ARGS 2
+#define ARGV_DECK 1
+#define DEFAULT_DECK "deck"
+#define GAMES 256
+#define TURNS 400
+#define MIN_PLAYERS 2
+#define MOST_PLAYERS 5
+#define MOST_TOKENS 6
+#define TAKE_MASKS (1 << MAX_TOKEN_COLOUR)
+#define WILD_TOKENS MAX_TOKEN_COLOUR
+#define CHECK_FAILED 1
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Sets up a new game with the players, markets and tokens picked from the
+ * number of the game and fills every market from the deck
+ *
+ * state: state of the game
+ *
+ * deck: deck the markets are filled from. Cards are reused once it runs out
+ *
+ * number: number of the game
+ */
+static void start_game(GameState* state, Deck* deck, int number);
+
+/*
+ * Compares the moves listed for a player with every take check_action()
+ * accepts and every market can_pay() says the player can buy
+ *
+ * state: state of the game
+ *
+ * player: player to move
+ *
+ * return: returns the number of differences found
+ */
+static int check_position(GameState* state, int player);
+
+/*
+ * Checks a listed purchase pays for all of the market with no more wild
+ * tokens than the player has
+ *
+ * state: state of the game
+ *
+ * player: player buying
+ *
+ * move: purchase to check
+ *
+ * return: returns true if the payment covers the cost else false
+ */
+static bool pays_in_full(GameState* state, int player, Action* move);
+
+/*
+ * Works out if a player can buy a card from their tokens, discounts and
+ * wild tokens one colour at a time without the masks of afford.c
+ *
+ * state: state of the game
+ *
+ * player: player buying
+ *
+ * card: card to buy
+ *
+ * return: returns true if the player can pay for the card else false
+ */
+static bool can_pay(GameState* state, int player, Card* card);
+
+/*
+ * Finds a move in a list of moves
+ *
+ * moves: list of moves
+ *
+ * count: number of moves in the list
+ *
+ * move: move to find. Purchases match on the market only
+ *
+ * return: returns true if the move is listed else false
+ */
+static bool is_listed(Action* moves, int count, Action* move);
+
+/*
+ * Prints a position where the moves listed and check_action() disagree
+ *
+ * state: state of the game
+ *
+ * player: player to move
+ *
+ * move: move that was listed wrongly or left out
+ *
+ * problem: what is wrong with the move
+ */
+static void report(GameState* state, int player, Action* move,
+        const char* problem);
+
+////////////////////////////// Global Variables ///////////////////////////////
+
+/* Game being checked. Too big to keep on the stack */
+static GameState game;
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int main(int argc, char** argv) {
+    Deck deck;
+    Card bought;
+    Action moves[MAX_MOVES];
+    long positions = 0;
+    long listed = 0;
+    int failures = 0;
+
+    if (!is_num_args_valid(argc, 1, MAX_ARGS)) {
+        fprintf(stderr, "Usage: checkMoves [deck]\n");
+        return WRONG_NUM_ARGS;
+    } else if (open_deck(argc == MAX_ARGS ? argv[ARGV_DECK] : DEFAULT_DECK,
+            &deck, true) != VALID) {
+        fprintf(stderr, "Cannot read deck file\n");
+        return INVALID_DECK;
+    }
+
+    for (int number = 0; number < GAMES; number++) {
+        srand(number);
+        start_game(&game, &deck, number);
+        for (int turn = 0; turn < TURNS; turn++) {
+            int player = turn % game.player.count;
+            int count = legal_moves(&game, player, moves);
+            Action* move = &moves[rand() % count];
+
+            failures += check_position(&game, player);
+            positions++;
+            listed += count;
+            if (apply_action(&game, player, move, &bought) != RULE_APPLIED) {
+                report(&game, player, move, "listed but not applied");
+                failures++;
+            } else if (move->type == ACTION_PURCHASE) {
+                add_to_board(&game,
+                        &deck.cards[deck.deckIndex++ % deck.size]);
+            }
+        }
+    }
+    close_deck(&deck);
+
+    printf("Checked %ld positions of %d games, %ld moves listed, "
+            "%d differences\n", positions, GAMES, listed, failures);
+    return (failures == 0) ? 0 : CHECK_FAILED;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void start_game(GameState* state, Deck* deck, int number) {
+    memset(state, 0, sizeof(GameState));
+    state->player.count = MIN_PLAYERS +
+            number % (MOST_PLAYERS - MIN_PLAYERS + 1);
+    state->board.size = 1 + number % MAX_MARKETS;
+    state->tokenPile.maxTokens = number % (MOST_TOKENS + 1);
+    init_board(state);
+    init_tokens(state);
+    for (int market = 0; market < state->board.size; market++) {
+        add_to_board(state, &deck->cards[deck->deckIndex++ % deck->size]);
+    }
+}
+
+//
+static int check_position(GameState* state, int player) {
+    Action moves[MAX_MOVES];
+    Action move;
+    int count = legal_moves(state, player, moves);
+    int failures = 0;
+
+    if (moves[count - 1].type != ACTION_WILD) {
+        report(state, player, &moves[count - 1], "wild is not last");
+        failures++;
+    }
+    for (int index = 0; index < count; index++) {
+        if (check_action(state, player, &moves[index]) != RULE_APPLIED) {
+            report(state, player, &moves[index], "listed but not legal");
+            failures++;
+        } else if (moves[index].type == ACTION_PURCHASE &&
+                !pays_in_full(state, player, &moves[index])) {
+            report(state, player, &moves[index], "does not pay in full");
+            failures++;
+        }
+    }
+
+    memset(&move, 0, sizeof(Action));
+    move.type = ACTION_TAKE;
+    for (int mask = 0; mask < TAKE_MASKS; mask++) { // every take of 0 or 1
+        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+            move.tokens[colour] = (mask >> colour) & 1;
+        }
+        bool legal = check_action(state, player, &move) == RULE_APPLIED;
+        if (legal != is_listed(moves, count, &move)) {
+            report(state, player, &move, legal ? "legal but not listed" :
+                    "listed but not legal");
+            failures++;
+        }
+    }
+
+    move.type = ACTION_PURCHASE;
+    for (int market = 0; market < MAX_MARKETS; market++) {
+        // the most the rules let a player pay with
+        move.boardIndex = market;
+        memcpy(move.tokens, state->player.tokens[player],
+                sizeof(long) * MAX_TOKEN_COLOUR);
+        move.tokens[WILD_TOKENS] = state->player.wildPile[player];
+        bool legal = market < state->board.count && can_pay(state, player,
+                check_market_card(state, market));
+        if (legal != is_listed(moves, count, &move)) {
+            report(state, player, &move, legal ? "legal but not listed" :
+                    "listed but not legal");
+            failures++;
+        }
+        if (legal != (check_action(state, player, &move) == RULE_APPLIED)) {
+            report(state, player, &move, legal ? "refused by the rules" :
+                    "allowed by the rules");
+            failures++;
+        }
+    }
+    return failures;
+}
+
+//
+static bool pays_in_full(GameState* state, int player, Action* move) {
+    Card* card = check_market_card(state, move->boardIndex);
+    long wild = 0;
+
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        long missing = card->cost[colour] -
+                state->player.discountList[player][colour] -
+                move->tokens[colour];
+        if (missing > state->player.wildPile[player] - wild) {
+            return false; // more than the player has
+        }
+        wild += (missing > 0) ? missing : 0;
+    }
+    return wild == move->tokens[WILD_TOKENS] &&
+            wild <= state->player.wildPile[player];
+}
+
+//
+static bool can_pay(GameState* state, int player, Card* card) {
+    long wild = state->player.wildPile[player];
+
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        long held = state->player.tokens[player][colour] +
+                state->player.discountList[player][colour];
+        if (card->cost[colour] <= held) {
+            continue;
+        } else if (card->cost[colour] - held > wild) {
+            return false;
+        }
+        wild -= card->cost[colour] - held;
+    }
+    return true;
+}
+
+//
+static bool is_listed(Action* moves, int count, Action* move) {
+    for (int index = 0; index < count; index++) {
+        if (moves[index].type != move->type) {
+            continue;
+        } else if (move->type == ACTION_PURCHASE &&
+                moves[index].boardIndex == move->boardIndex) {
+            return true;
+        } else if (move->type == ACTION_TAKE && memcmp(moves[index].tokens,
+                move->tokens, sizeof(long) * MAX_TOKEN_COLOUR) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//
+static void report(GameState* state, int player, Action* move,
+        const char* problem) {
+    fprintf(stderr, "Player %c %s: type %d market %d tokens "
+            "%ld,%ld,%ld,%ld,%ld with %d markets, pile %ld,%ld,%ld,%ld\n",
+            player_int_to_char(player), problem, move->type,
+            move->boardIndex, move->tokens[PURPLE], move->tokens[BROWN],
+            move->tokens[YELLOW], move->tokens[RED], move->tokens[WILD_TOKENS],
+            state->board.count, state->tokenPile.pile[PURPLE],
+            state->tokenPile.pile[BROWN], state->tokenPile.pile[YELLOW],
+            state->tokenPile.pile[RED]);
+}
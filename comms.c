@@ -8,56 +8,114 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
 
 #include "comms.h"
+#include "wire.h"
 #include "lib.h"
+#include "ring.h"
 
 /////////////////////////////////// Defines ///////////////////////////////////
 
 #define ZERO 48
 #define NINE 57
-#define SEVEN 55
 #define FLAGGED 1
 #define BASE 10
 
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Reads more into the buffer of a reader. Any unfinished line is moved to
+ * the front of the buffer first and the buffer is doubled if the line 
+ * already fills it. Always leaves room for a '\0' after the data.
+ *
+ * reader: reader to fill
+ *
+ * return: returns 0 at EOF or on a read error else returns 1
+ */
+static int fill_reader(Reader* reader);
+
 ////////////////////////////////// Functions //////////////////////////////////
 
-char* rec_message(FILE* stream, int* streamEnd) {
-    int next;
-    int messageSize = 0;
-    char* message = malloc(sizeof(char) * 1);   
+bool open_reader(Reader* reader, int fd, RingEnd* ring) {
+    reader->fd = fd;
+    reader->ring = ring;
+    reader->size = READ_BUFFER;
+    reader->start = 0;
+    reader->end = 0;
+    reader->buffer = malloc(sizeof(char) * reader->size);
+    return reader->buffer != NULL;
+}
+
+void close_reader(Reader* reader) {
+    free(reader->buffer);
+    reader->buffer = NULL;
+}
+
+char* read_line(Reader* reader, int* length, int* streamEnd) {
+    char* newLine;
+    char* line;
     *streamEnd = 0;
 
-    FOREVER {
-        next = fgetc(stream);
-        switch (next) {
-            case EOF:
-                if (messageSize != 0) { // there is a message but EOF was found
-                    *streamEnd = FLAGGED;
-                    message[messageSize] = '\0';
-                    return message;
-                } else {
-                    free(message);
-                    return NULL;
-                }
-            case '\n':
-                message[messageSize] = '\0';
-                return message;
-            default:
-                message = realloc(message, sizeof(char) * messageSize + 2);
-                message[messageSize] = next;
-                messageSize++;
+    while ((newLine = memchr(&reader->buffer[reader->start], '\n', 
+            reader->end - reader->start)) == NULL) {
+        if (!fill_reader(reader)) { // EOF
+            if (reader->end == reader->start) {
+                return NULL;
+            }
+            *streamEnd = FLAGGED; // there is a message but EOF was found
+            newLine = &reader->buffer[reader->end];
+            break;
         }
     }
+    line = &reader->buffer[reader->start];
+    *newLine = '\0';
+    if (length != NULL) {
+        *length = newLine - line;
+    }
+    reader->start = (newLine - reader->buffer) + (*streamEnd ? 0 : 1);
+    if (*streamEnd) {
+        reader->end = reader->start; // nothing is left to hand out
+    }
+    return line;
+}
+
+char* read_record(Reader* reader, int* streamEnd) {
+    char* record;
+    *streamEnd = 0;
+
+    while (reader->end == reader->start || reader->end - reader->start < 
+            record_size(reader->buffer[reader->start])) {
+        if (!fill_reader(reader)) { // EOF
+            if (reader->end == reader->start) {
+                return NULL;
+            }
+            *streamEnd = FLAGGED; // only part of a record before EOF
+            record = &reader->buffer[reader->start];
+            reader->start = reader->end;
+            return record;
+        }
+    }
+    record = &reader->buffer[reader->start];
+    reader->start += record_size(*record);
+    return record;
 }
 
 bool is_valid_purchase(long* tokens, char* mesIndex, int* boardIndex) {
 
-    if (mesIndex[0] < ZERO || mesIndex[0] > SEVEN || mesIndex[1] != ':') {
+    long index;
+
+    if (mesIndex[0] < ZERO || mesIndex[0] > NINE) {
         return false;
     }
-    *boardIndex = (mesIndex[0] - ZERO);
-    mesIndex = &mesIndex[2];
+    index = strtol(mesIndex, &mesIndex, BASE);
+    if (index >= MAX_MARKETS || mesIndex[0] != ':') {
+        return false;
+    }
+    *boardIndex = index;
+    mesIndex = &mesIndex[1];
     // also checks wild unlike is_valid_take()
     for (int i = 0; i <= MAX_TOKEN_COLOUR; i++) { // for each colour
         if (mesIndex[0] < ZERO || mesIndex[0] > NINE) { // not a number
@@ -99,7 +157,6 @@ void print_winners(GameState* state, char* message, FILE* stream) {
     int count = 0;
 
     fprintf(stream, "%s", message);
-    fflush(stream);
 
     for (int i = 0; i < state->player.count; i++) { // checks the highest score
         if (highest < state->player.scoreCard[i]) {
@@ -113,12 +170,70 @@ void print_winners(GameState* state, char* message, FILE* stream) {
         if (state->player.scoreCard[i] == highest) {
             if (count > 1) {
                 fprintf(stream, "%c,", player_int_to_char(i));
-                fflush(stream);
                 count--;
             } else {
                 fprintf(stream, "%c\n", player_int_to_char(i));
-                fflush(stream);
             }
         }
     }
-}
\ No newline at end of file
+}
+
+void print_table(GameState* state, FILE* stream) {
+    if (state->table > 0) {
+        fprintf(stream, "Table %d: ", state->table);
+    }
+}
+
+bool is_unix_address(const char* name) {
+    size_t prefix = strlen(UNIX_PREFIX);
+
+    return strncmp(name, UNIX_PREFIX, prefix) == 0 && name[prefix] != '\0';
+}
+
+bool unix_address(struct sockaddr_un* address, const char* name) {
+    const char* path = &name[strlen(UNIX_PREFIX)];
+
+    if (!is_unix_address(name) || strlen(path) >= sizeof(address->sun_path)) {
+        return false;
+    }
+    memset(address, 0, sizeof(struct sockaddr_un));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, path);
+    return true;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int fill_reader(Reader* reader) {
+    int got;
+
+    if (reader->start > 0) { // move the unfinished line to the front
+        memmove(reader->buffer, &reader->buffer[reader->start], 
+                reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+    }
+    if (reader->end == reader->size - 1) { // line fills the whole buffer
+        char* bigger = realloc(reader->buffer, reader->size * 2);
+        if (bigger == NULL) {
+            return FAIL;
+        }
+        reader->buffer = bigger;
+        reader->size *= 2;
+    }
+    do {
+        if (reader->ring != NULL) {
+            got = ring_read_wait(reader->ring, &reader->buffer[reader->end], 
+                    reader->size - 1 - reader->end);
+        } else {
+            got = read(reader->fd, &reader->buffer[reader->end], 
+                    reader->size - 1 - reader->end);
+        }
+    } while (got < 0 && errno == EINTR);
+
+    if (got <= 0) {
+        return FAIL;
+    }
+    reader->end += got;
+    return VALID;
+}
@@ -8,21 +8,69 @@
 #ifndef COMMS_H
 #define COMMS_H
 
+#include <sys/un.h>
+
 #include "lib.h"
 
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define UNIX_PREFIX "unix:"
+#define SEAT_MESSAGE "seat"
+
 ///////////////////////// Public Function Prototypes //////////////////////////
 
 /*
- * receives a message from the stream and puts it into a string.
+ * Sets up a reader on a file descriptor or a ring
  *
- * stream: place we are trying to get the message from
+ * reader: reader to set up
+ *
+ * fd: file descriptor to read from
+ *
+ * ring: ring to read from instead of fd. NULL to read from fd
+ *
+ * return: returns false if the buffer could not be allocated else true
+ */
+bool open_reader(Reader* reader, int fd, RingEnd* ring);
+
+/*
+ * Frees the buffer of a reader. The file descriptor is not closed.
+ *
+ * reader: reader to free
+ */
+void close_reader(Reader* reader);
+
+/*
+ * receives a message from the reader. The buffer is refilled with as much
+ * as can be read at once only when it holds no complete line. The message
+ * is borrowed from the readers buffer and is only valid until the next 
+ * call.
+ *
+ * reader: place we are trying to get the message from
+ *
+ * length: storage for the length of the message. May be NULL
  *
  * streamEnd: Signals that EOF was received but there is a message waiting
  *
- * return: returns a pointer to the message that was received.
- *         returns a NULL pointer if EOF was received and there is no message
+ * return: returns a pointer to the message that was received without its
+ *         newline. returns a NULL pointer if EOF was received and there is
+ *         no message
+ */
+char* read_line(Reader* reader, int* length, int* streamEnd);
+
+/*
+ * receives a record of the binary protocol from the reader. The size of
+ * the record is worked out from its type byte. The buffer is refilled only
+ * when it holds less than a whole record. The record is borrowed from the
+ * readers buffer and is only valid until the next call.
+ *
+ * reader: place we are trying to get the record from
+ *
+ * streamEnd: Signals that EOF was received part way through a record
+ *
+ * return: returns a pointer to the record. returns a NULL pointer if EOF
+ *         was received and there is nothing left
  */
-char* rec_message(FILE* stream, int* streamEnd);
+char* read_record(Reader* reader, int* streamEnd);
 
 /*
  * checks if a purchase message is of a valid format and stores the information
@@ -30,7 +78,7 @@ char* rec_message(FILE* stream, int* streamEnd);
  * format for a purchase message should be:
  *
  * "C:TP,TB,TY,TR,TW"
- * C:  card index
+ * C:  card index. Can be more than 1 digit but must be below MAX_MARKETS
  * TP: Number Purple to use
  * TB: Number Brown to use
  * TY: Number Yellow to use
@@ -79,8 +127,47 @@ bool is_valid_take(long* tokens, char* mesIndex);
  *
  * message: message to print
  *
- * stream: output to send message to
+ * stream: output to send message to. Not flushed
  */
 void print_winners(GameState* state, char* message, FILE* stream);
 
+/*
+ * prints the name of the table a game is at so lines from many tables can
+ * be told apart. Nothing is printed if the hub only has one table.
+ * print will be of the format
+ *
+ * "Table N: "
+ * N: number of the table starting at 1
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * stream: output to print to. Not flushed
+ */
+void print_table(GameState* state, FILE* stream);
+
+/*
+ * checks if a name is the address of a player daemon listening on a unix
+ * domain socket. Addresses are of the format
+ *
+ * "unix:PATH"
+ * PATH: path of the socket the daemon listens on
+ *
+ * name: name to be checked
+ *
+ * return: true if the name starts with "unix:" and has a path else false
+ */
+bool is_unix_address(const char* name);
+
+/*
+ * fills in a unix domain socket address from a "unix:PATH" name
+ *
+ * address: storage for the socket address
+ *
+ * name: "unix:PATH" name of the address
+ *
+ * return: true if the name is an address that fits in a socket address
+ *         else false
+ */
+bool unix_address(struct sockaddr_un* address, const char* name);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,259 @@
+/* costs.c
+ *
+ * Author: Michael Bossner
+ *
+ * costs.c contains the kernels that work out what every market on the board
+ * costs a player at once. Costs are packed as ints colour by colour so each
+ * kernel handles several markets per instruction with AVX2 or SSE2 when the
+ * compiler targets them and a plain loop otherwise. Anything too big to 
+ * pack falls back to the plain loop over the cards.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <string.h>
+
+#include "costs.h"
+#include "afford.h"
+#include "board.h"
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LANES 8
+typedef __m256i Lanes;
+#define LOAD(place) _mm256_loadu_si256((const Lanes*)(place))
+#define STORE(place, value) _mm256_storeu_si256((Lanes*)(place), value)
+#define SPLAT(value) _mm256_set1_epi32(value)
+#define ZEROS() _mm256_setzero_si256()
+#define ADD(a, b) _mm256_add_epi32(a, b)
+#define SUB(a, b) _mm256_sub_epi32(a, b)
+#define AND(a, b) _mm256_and_si256(a, b)
+#define GREATER(a, b) _mm256_cmpgt_epi32(a, b)
+#define MASK(value) _mm256_movemask_ps(_mm256_castsi256_ps(value))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LANES 4
+typedef __m128i Lanes;
+#define LOAD(place) _mm_loadu_si128((const Lanes*)(place))
+#define STORE(place, value) _mm_storeu_si128((Lanes*)(place), value)
+#define SPLAT(value) _mm_set1_epi32(value)
+#define ZEROS() _mm_setzero_si128()
+#define ADD(a, b) _mm_add_epi32(a, b)
+#define SUB(a, b) _mm_sub_epi32(a, b)
+#define AND(a, b) _mm_and_si128(a, b)
+#define GREATER(a, b) _mm_cmpgt_epi32(a, b)
+#define MASK(value) _mm_movemask_ps(_mm_castsi128_ps(value))
+#endif
+
+#define ALL_MARKETS(count) \
+        ((count) >= 64 ? ~0ULL : (1ULL << (count)) - 1)
+#define POSITIVE(value) ((value) > 0 ? (value) : 0)
+#define SATURATE(value) ((value) > INT_MAX ? INT_MAX : (int)(value))
+// a cost this big still saturates after any discount so adding no more than
+// this of each colour can not overflow
+#define WIDE_MAX (2L * INT_MAX)
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Gets what a player holds of each colour if it can be packed
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player buying
+ *
+ * tokens: storage for the tokens of each colour
+ *
+ * discounts: storage for the discounts of each colour
+ *
+ * return: returns false if the board or the player can not be packed and
+ *         the plain loop must be used else true
+ */
+static bool load_player(GameState* state, int player, int* tokens, 
+        int* discounts);
+
+/*
+ * Checks if a card has a cost too big to pack
+ *
+ * card: card to check
+ *
+ * return: returns true if a cost is bigger than PACKED_MAX
+ */
+static bool is_wide(Card* card);
+
+////////////////////////////////// Functions //////////////////////////////////
+
+void pack_costs(GameState* state, int boardIndex) {
+    Card* card = check_market_card(state, boardIndex);
+
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        state->board.costs[colour][boardIndex] = 
+                is_wide(card) ? 0 : card->cost[colour];
+    }
+    state->board.wideCards += is_wide(card);
+}
+
+void unpack_costs(GameState* state, int boardIndex) {
+    int younger = state->board.count - boardIndex - 1;
+
+    state->board.wideCards -= is_wide(check_market_card(state, boardIndex));
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        memmove(&state->board.costs[colour][boardIndex], 
+                &state->board.costs[colour][boardIndex + 1], 
+                sizeof(int) * younger);
+    }
+}
+
+unsigned long long affordable_markets(GameState* state, int player) {
+    int tokens[MAX_TOKEN_COLOUR];
+    int discounts[MAX_TOKEN_COLOUR];
+    int need[MAX_MARKETS];
+    unsigned long long mask = 0;
+    int count = market_count(state);
+    long wild = state->player.wildPile[player];
+
+    if (!load_player(state, player, tokens, discounts)) {
+        for (int market = 0; market < count; market++) {
+            mask |= (unsigned long long)can_afford(state, player, 
+                    check_market_card(state, market)) << market;
+        }
+        return mask;
+    }
+    wild_needed(state, player, need);
+#ifdef LANES
+    Lanes wilds = SPLAT(SATURATE(wild));
+    for (int market = 0; market < count; market += LANES) {
+        Lanes tooMuch = GREATER(LOAD(&need[market]), wilds);
+        mask |= (unsigned long long)(~MASK(tooMuch) & ((1 << LANES) - 1)) << 
+                market;
+    }
+#else
+    for (int market = 0; market < count; market++) {
+        mask |= (unsigned long long)(need[market] <= wild) << market;
+    }
+#endif
+    return mask & ALL_MARKETS(count);
+}
+
+void wild_needed(GameState* state, int player, int* need) {
+    int tokens[MAX_TOKEN_COLOUR];
+    int discounts[MAX_TOKEN_COLOUR];
+    int count = market_count(state);
+
+    if (!load_player(state, player, tokens, discounts)) {
+        for (int market = 0; market < count; market++) {
+            Card* card = check_market_card(state, market);
+            long wild = 0;
+            for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+                long missing = POSITIVE(card->cost[colour] - 
+                        (state->player.tokens[player][colour] + 
+                        discounts[colour]));
+                wild += (missing > INT_MAX) ? INT_MAX : missing;
+            }
+            need[market] = SATURATE(wild);
+        }
+        return;
+    }
+#ifdef LANES
+    Lanes zeros = ZEROS();
+    for (int market = 0; market < count; market += LANES) {
+        Lanes total = zeros;
+        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+            Lanes missing = SUB(LOAD(&state->board.costs[colour][market]),
+                    SPLAT(tokens[colour] + discounts[colour]));
+            total = ADD(total, AND(missing, GREATER(missing, zeros)));
+        }
+        STORE(&need[market], total);
+    }
+#else
+    for (int market = 0; market < count; market++) {
+        int total = 0;
+        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+            total += POSITIVE(state->board.costs[colour][market] - 
+                    (tokens[colour] + discounts[colour]));
+        }
+        need[market] = total;
+    }
+#endif
+}
+
+void total_costs(GameState* state, int player, int* totals) {
+    int tokens[MAX_TOKEN_COLOUR];
+    int discounts[MAX_TOKEN_COLOUR];
+    int count = market_count(state);
+
+    if (!load_player(state, player, tokens, discounts)) {
+        for (int market = 0; market < count; market++) {
+            Card* card = check_market_card(state, market);
+            long total = 0;
+            for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+                total += (card->cost[colour] > WIDE_MAX) ? WIDE_MAX : 
+                        card->cost[colour];
+                if (card->cost[colour] > 0) {
+                    total = POSITIVE(total - 
+                            state->player.discountList[player][colour]);
+                }
+            }
+            totals[market] = SATURATE(total);
+        }
+        return;
+    }
+#ifdef LANES
+    Lanes zeros = ZEROS();
+    for (int market = 0; market < count; market += LANES) {
+        Lanes total = zeros;
+        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+            Lanes cost = LOAD(&state->board.costs[colour][market]);
+            // discounts only come off colours the card costs
+            total = SUB(ADD(total, cost), 
+                    AND(SPLAT(discounts[colour]), GREATER(cost, zeros)));
+            total = AND(total, GREATER(total, zeros));
+        }
+        STORE(&totals[market], total);
+    }
+#else
+    for (int market = 0; market < count; market++) {
+        int total = 0;
+        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+            int cost = state->board.costs[colour][market];
+            total += cost;
+            if (cost > 0) {
+                total = POSITIVE(total - discounts[colour]);
+            }
+        }
+        totals[market] = total;
+    }
+#endif
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static bool load_player(GameState* state, int player, int* tokens, 
+        int* discounts) {
+    bool packed = state->board.wideCards == 0;
+
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        long held = state->player.tokens[player][colour];
+        int discount = state->player.discountList[player][colour];
+
+        packed = packed && held >= 0 && held <= PACKED_MAX && 
+                discount >= 0 && discount <= PACKED_MAX;
+        tokens[colour] = SATURATE(held);
+        discounts[colour] = discount;
+    }
+    return packed;
+}
+
+//
+static bool is_wide(Card* card) {
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        if (card->cost[colour] < 0 || card->cost[colour] > PACKED_MAX) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,80 @@
+/* costs.h
+ *
+ * Author: Michael Bossner
+ *
+ * costs.h header file for costs.c
+ */
+
+#ifndef COSTS_H
+#define COSTS_H
+
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+/* Largest cost, token count or discount that is packed. Four of them still
+ * add up to less than INT_MAX */
+#define PACKED_MAX (1 << 28)
+
+///////////////////////// Public Functions Prototypes /////////////////////////
+
+/*
+ * Packs the cost of a market into the boards cost columns. Called when a
+ * market is set up.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * boardIndex: index of the market
+ */
+void pack_costs(GameState* state, int boardIndex);
+
+/*
+ * Removes the cost of a market from the boards cost columns and moves the
+ * younger markets down one. Called before the market is removed.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * boardIndex: index of the market
+ */
+void unpack_costs(GameState* state, int boardIndex);
+
+/*
+ * Works out which markets a player can afford
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player buying
+ *
+ * return: returns a mask with the bit of each market the player can afford
+ */
+unsigned long long affordable_markets(GameState* state, int player);
+
+/*
+ * Works out how many wild tokens a player needs to buy each market. The 
+ * same as the wild worked out by load_tokens().
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player buying
+ *
+ * need: storage for the wild tokens needed for each market. Must hold
+ *       MAX_MARKETS ints
+ */
+void wild_needed(GameState* state, int player, int* need);
+
+/*
+ * Works out the total cost of each market after the discounts of a player
+ * the same way the strategies always have. Discounts are taken off the
+ * running total for each colour the card costs and the total never goes 
+ * below 0.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player buying
+ *
+ * totals: storage for the total cost of each market. Must hold MAX_MARKETS
+ *         ints
+ */
+void total_costs(GameState* state, int player, int* totals);
+
+#endif
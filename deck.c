@@ -7,112 +7,151 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <limits.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "deck.h"
+#include "deckFile.h"
 #include "lib.h"
 #include "endAusterity.h"
-#include "comms.h"
 #include "card.h"
-
-/////////////////////////////////// Defines ///////////////////////////////////
-
-#define MIN_CARDS 1
-#define INVALID -1
-#define FILE_END 0
-#define CARD_END 1
+#include "comms.h"
 
 //////////////////////// Private Functions Prototypes /////////////////////////
 
 /*
- * Adds a new card to the deck pile if it is of a valid format
- * Minimum amount of cards in a deck file should be at least 1.
- * Format should be each card on it's own line with EOF on it's own line:
- *
- * "D:V:P,B,Y,R\n"
- * "D:V:P,B,Y,R\n"
- * "EOF"
+ * Opens a text deck to be read while playing and checks it has a card.
+ * Compiled decks are not streamed as mapping them already only reads in
+ * the cards that are drawn.
  *
- * D: Colour of the card either 'B' || 'Y' || 'P' || 'R'
- * v: number of points the card gives. Must be a positive number
- * P: number of Purple tokens the card costs. Must be a positive number
- * B: number of Brown tokens the card costs. Must be a positive number
- * Y: number of Yellow tokens the card costs. Must be a positive number
- * R: number of Red tokens the card costs. Must be a positive number
- *
- * deckFile: Name of the file that contains the deck
+ * deckFileName: Name of the file that contains the deck
  *
  * state: Contains all information needed to keep track of the game
  *
- * return: Returns -1 if EOF is received at the start of the line
- *         Returns 0 if the deck file is invalid
- *         Returns 1 if card was added successfully
+ * return: returns false if the deck is compiled else true
+ *
+ * Error 3: Cannot access deck file.
  *
- * Error 4: Invalid deck file contents. deckFile does not meet the format
+ * Error 4: Invalid deck file contents. The deck has no cards
  */
-static int add_card(FILE* deckFile, GameState* state);
+static bool open_stream(char* deckFileName, GameState* state);
 
 ////////////////////////////////// Functions //////////////////////////////////
 
 void load_deck_file(char* deckFileName, GameState* state) {
-    FILE* deckFile = fopen(deckFileName, "r");
-    if (deckFile == NULL) {
-        end_austerity(state, CANNOT_OPEN_DECK);
+    int status;
+
+    if (state->config.streamDeck && open_stream(deckFileName, state)) {
+        return;
+    } else if ((status = open_deck(deckFileName, &state->deck, false)) != 
+            VALID) {
+        end_austerity(state, status);
+    }
+}
+
+Card* next_card(GameState* state) {
+    DeckStream* stream = state->deck.stream;
+    char* line;
+    int length;
+    int streamEnd;
+
+    if (stream == NULL) {
+        return (state->deck.deckIndex < state->deck.size) ? 
+                &state->deck.cards[state->deck.deckIndex] : NULL;
+    } else if (stream->ended) {
+        return NULL;
+    } else if (stream->read) {
+        return &stream->next;
     }
 
-    state->deck.size = 0;
+    if ((line = read_line(&stream->reader, &length, &streamEnd)) == NULL) {
+        stream->ended = true; // EOF at the start of a line
+        return NULL;
+    } else if (streamEnd || !parse_card(line, length, &stream->next)) {
+        end_austerity(state, INVALID_DECK);
+    }
+    stream->read = true;
+    return &stream->next;
+}
+
+void draw_card(GameState* state) {
+    state->deck.deckIndex++;
+    if (state->deck.stream != NULL) {
+        state->deck.stream->read = false;
+    }
+}
+
+void rewind_deck(GameState* state) {
+    DeckStream* stream = state->deck.stream;
+
     state->deck.deckIndex = 0;
-    // Creates storage for a single card
-    state->deck.cardPile = malloc(sizeof(Card*) * MIN_CARDS);
-    // Adds all cards to the pile and keeps count
-    while (add_card(deckFile, state) > 0) {
-        state->deck.size++;
-        state->deck.cardPile = realloc(state->deck.cardPile, 
-                sizeof(Card*) * (state->deck.size + 1));
+    if (stream == NULL) {
+        return;
+    } else if (lseek(stream->reader.fd, 0, SEEK_SET) != 0) {
+        end_austerity(state, CANNOT_OPEN_DECK);
     }
-    fclose(deckFile);
+    stream->reader.start = 0;
+    stream->reader.end = 0;
+    stream->read = false;
+    stream->ended = false;
 }
 
 void free_deck(GameState* state) {
-    for (int i = 0; i < state->deck.size; i++) {
-        free(state->deck.cardPile[i]);
+    DeckStream* stream = state->deck.stream;
+
+    if (stream != NULL) {
+        close(stream->reader.fd);
+        close_reader(&stream->reader);
+        free(stream);
+        state->deck.stream = NULL;
     }
-    free(state->deck.cardPile);
+    close_deck(&state->deck);
 }
 
 ////////////////////////////// Private Functions //////////////////////////////
 //
-static int add_card(FILE* deckFile, GameState* state) {
+static bool open_stream(char* deckFileName, GameState* state) {
+    DeckStream* stream = malloc(sizeof(DeckStream));
+    int fd = open(deckFileName, O_RDONLY);
+    Reader* reader;
+    int got = 0;
 
-    Card* card = malloc(sizeof(Card) * 1);
-    char* message;
-    int status;
-    int streamEnd;
-    if ((message = rec_message(deckFile, &streamEnd)) == NULL) { // EOF line
-        status = INVALID;
-    } else if (streamEnd) { // message 'EOF' terminated
-        status = FAIL;
-    } else { // normal message '\n' terminated
-        status = unwrap_card(message, card);
+    if (stream == NULL || fd < 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        free(stream);
+        end_austerity(state, CANNOT_OPEN_DECK);
+    }
+    reader = &stream->reader;
+    if (!open_reader(reader, fd, NULL)) {
+        free(stream);
+        close(fd);
+        end_austerity(state, CANNOT_OPEN_DECK);
     }
 
-    switch (status) {
-        case FAIL:
-            free(card);
-            free(message);
-            fclose(deckFile);
-            end_austerity(state, INVALID_DECK);
-        case INVALID:
-            free(card);     
-            if (state->deck.size == 0) { // Only fails if there are no cards
-                fclose(deckFile);
-                end_austerity(state, INVALID_DECK);
-            }
-            break;
-        default:
-            free(message);
-            state->deck.cardPile[state->deck.size] = card;
+    // reads far enough to see if the deck is compiled. The reader then 
+    // hands out what was read as the start of the first card
+    while (reader->end < DECK_MAGIC_SIZE && ((got = read(fd, 
+            &reader->buffer[reader->end], reader->size - 1 - reader->end)) 
+            > 0 || (got < 0 && errno == EINTR))) {
+        reader->end += (got > 0) ? got : 0;
     }
-    return status;
-}
\ No newline at end of file
+    if (reader->end >= DECK_MAGIC_SIZE && 
+            memcmp(reader->buffer, DECK_MAGIC, DECK_MAGIC_SIZE) == 0) {
+        close_reader(reader);
+        close(fd);
+        free(stream);
+        return false;
+    }
+    stream->read = false;
+    stream->ended = false;
+    state->deck.stream = stream;
+
+    if (next_card(state) == NULL) { // there must be at least 1 card
+        end_austerity(state, INVALID_DECK);
+    }
+    return true;
+}
@@ -31,6 +31,11 @@
  * Y: number of Yellow tokens the card costs. Must be a positive number
  * R: number of Red tokens the card costs. Must be a positive number
  *
+ * A deck compiled by deckc is mapped and used without parsing instead.
+ * With -z a text deck is not loaded but read a chunk at a time as cards are
+ * drawn, so only the first card is checked here. Compiled decks are always
+ * mapped as their cards are only read in when drawn.
+ *
  * deckFile: Name of the file that contains the deck
  *
  * state: Contains all information needed to keep track of the game
@@ -41,6 +46,36 @@
  */
 void load_deck_file(char* deckFileName, GameState* state);
 
+/*
+ * Finds the next card to draw from the deck without drawing it. Streamed
+ * decks read the card from the file the first time it is asked for.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * return: returns the next card or NULL if every card has been drawn. The
+ *         card is only valid until it is drawn
+ *
+ * Error 4: Invalid deck file contents. The streamed card is not valid
+ */
+Card* next_card(GameState* state);
+
+/*
+ * Draws the card returned by next_card() from the deck
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+void draw_card(GameState* state);
+
+/*
+ * Puts every card back in the deck for a new game. Streamed decks are read
+ * again from the start of the file.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * Error 3: Cannot access deck file. A streamed deck could not be rewound
+ */
+void rewind_deck(GameState* state);
+
 /*
  * frees the entire deck pile from memory
  *
@@ -0,0 +1,268 @@
+/* deckFile.c
+ *
+ * Author: Michael Bossner
+ *
+ * deckFile.c contains functions that read and write deck files
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "deckFile.h"
+#include "lib.h"
+#include "endAusterity.h"
+#include "card.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define MIN_CARDS 1
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Parses every card of a deck file straight into one array of cards in the
+ * deck. Each line must be a valid card ending in '\n' and there must be at
+ * least MIN_CARDS cards. The array is sized from the length of the text as
+ * no card line is shorter than MIN_CARD_LEN + 1 and is shrunk to fit once
+ * all cards are parsed.
+ *
+ * deck: deck the cards are stored in
+ *
+ * text: contents of the deck file. Does not need to be '\0' terminated
+ *
+ * length: number of characters in text
+ *
+ * return: returns false if the deck file is invalid else true
+ */
+static bool parse_deck(Deck* deck, const char* text, long length);
+
+/*
+ * Uses the cards of a compiled deck where they are. The header must match
+ * this build, the file must hold exactly the number of cards it says and
+ * every card must be one a text deck could hold.
+ * Mapped files stay mapped for the life of the deck and files that were
+ * read have their cards moved to the start of the buffer.
+ *
+ * deck: deck the cards are stored in
+ *
+ * text: contents of the compiled deck file
+ *
+ * length: number of bytes in text
+ *
+ * mapped: true if text is mapped else it was malloced
+ *
+ * verify: true to check the checksum
+ *
+ * return: returns VALID or INVALID_DECK. text is released if invalid
+ */
+static int use_compiled(Deck* deck, char* text, long length, bool mapped,
+        bool verify);
+
+/*
+ * Reads all of a deck file that could not be mapped, such as a pipe, into
+ * memory.
+ *
+ * fd: file descriptor of the deck file
+ *
+ * length: storage for the number of characters read
+ *
+ * return: returns the contents of the file or NULL if it could not be read
+ */
+static char* read_deck(int fd, long* length);
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int open_deck(char* fileName, Deck* deck, bool verify) {
+    struct stat info;
+    char* text = MAP_FAILED;
+    long length = 0;
+    bool mapped = false;
+    bool valid;
+    int fd = open(fileName, O_RDONLY);
+
+    deck->size = 0;
+    deck->deckIndex = 0;
+    deck->cards = NULL;
+    deck->mapLength = 0;
+    if (fd < 0) {
+        return CANNOT_OPEN_DECK;
+    } else if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && 
+            info.st_size > 0) {
+        length = info.st_size;
+        text = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (text != MAP_FAILED) {
+        mapped = true;
+    } else if ((text = read_deck(fd, &length)) == NULL) {
+        close(fd);
+        return CANNOT_OPEN_DECK;
+    }
+    close(fd);
+
+    if (length >= DECK_MAGIC_SIZE && 
+            memcmp(text, DECK_MAGIC, DECK_MAGIC_SIZE) == 0) {
+        return use_compiled(deck, text, length, mapped, verify);
+    } else if (mapped) { // text deck only needs to be read once
+        madvise(text, length, MADV_SEQUENTIAL);
+    }
+    valid = parse_deck(deck, text, length);
+    if (mapped) {
+        munmap(text, length);
+    } else {
+        free(text);
+    }
+    return valid ? VALID : INVALID_DECK;
+}
+
+void close_deck(Deck* deck) {
+    if (deck->mapLength > 0) {
+        munmap((char*)deck->cards - sizeof(DeckHeader), deck->mapLength);
+    } else {
+        free(deck->cards);
+    }
+    deck->cards = NULL;
+    deck->mapLength = 0;
+    deck->size = 0;
+}
+
+bool write_deck(char* fileName, Deck* deck) {
+    DeckHeader header;
+    FILE* file = fopen(fileName, "wb");
+    bool written;
+
+    if (file == NULL) {
+        return false;
+    }
+    memset(&header, 0, sizeof(DeckHeader));
+    memcpy(header.magic, DECK_MAGIC, DECK_MAGIC_SIZE);
+    header.version = DECK_VERSION;
+    header.cardSize = sizeof(Card);
+    header.count = deck->size;
+    header.checksum = deck_checksum(deck);
+
+    written = fwrite(&header, sizeof(DeckHeader), 1, file) == 1 && 
+            fwrite(deck->cards, sizeof(Card), deck->size, file) == 
+            (size_t)deck->size;
+    return (fclose(file) == 0) && written;
+}
+
+unsigned long long deck_checksum(Deck* deck) {
+    const unsigned char* bytes = (const unsigned char*)deck->cards;
+    size_t length = sizeof(Card) * deck->size;
+    unsigned long long hash = FNV_OFFSET;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static bool parse_deck(Deck* deck, const char* text, long length) {
+    const char* end = &text[length];
+    const char* newLine;
+
+    deck->size = 0;
+    // zeroed so the padding in each card hashes and compiles the same
+    deck->cards = calloc(length / (MIN_CARD_LEN + 1) + 1, sizeof(Card));
+    if (deck->cards == NULL) {
+        return false;
+    }
+    while (text < end) {
+        if ((newLine = memchr(text, '\n', end - text)) == NULL || 
+                !parse_card(text, newLine - text, &deck->cards[deck->size])) {
+            return false; // invalid card or last card not '\n' terminated
+        }
+        deck->size++;
+        text = &newLine[1];
+    }
+    if (deck->size < MIN_CARDS) {
+        return false;
+    }
+    Card* cards = realloc(deck->cards, sizeof(Card) * deck->size);
+    if (cards != NULL) { // keeps the bigger array if it could not shrink
+        deck->cards = cards;
+    }
+    return true;
+}
+
+//
+static int use_compiled(Deck* deck, char* text, long length, bool mapped,
+        bool verify) {
+    DeckHeader header;
+    long cardBytes = length - (long)sizeof(DeckHeader);
+
+    memcpy(&header, text, length < (long)sizeof(DeckHeader) ? 
+            length : (long)sizeof(DeckHeader));
+    if (cardBytes < 0 || header.version != DECK_VERSION || 
+            header.cardSize != sizeof(Card) || header.count < MIN_CARDS ||
+            header.count > INT_MAX || 
+            (unsigned long long)cardBytes != header.count * sizeof(Card)) {
+        if (mapped) {
+            munmap(text, length);
+        } else {
+            free(text);
+        }
+        return INVALID_DECK;
+    }
+    if (mapped) {
+        deck->cards = (Card*)&text[sizeof(DeckHeader)];
+        deck->mapLength = length;
+    } else {
+        memmove(text, &text[sizeof(DeckHeader)], cardBytes);
+        deck->cards = (Card*)text;
+    }
+    deck->size = header.count;
+
+    for (int index = 0; index < deck->size; index++) {
+        if (!is_card_valid(&deck->cards[index])) {
+            close_deck(deck);
+            return INVALID_DECK;
+        }
+    }
+    if (verify && deck_checksum(deck) != header.checksum) {
+        close_deck(deck);
+        return INVALID_DECK;
+    }
+    return VALID;
+}
+
+//
+static char* read_deck(int fd, long* length) {
+    long size = READ_BUFFER;
+    char* text = malloc(size);
+    ssize_t got;
+
+    *length = 0;
+    while (text != NULL && 
+            (got = read(fd, &text[*length], size - *length)) != 0) {
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            free(text);
+            return NULL;
+        }
+        *length += got;
+        if (*length == size) {
+            char* bigger = realloc(text, size * 2);
+            if (bigger == NULL) {
+                free(text);
+            }
+            text = bigger;
+            size *= 2;
+        }
+    }
+    return text;
+}
@@ -0,0 +1,62 @@
+/* deckFile.h
+ *
+ * Author: Michael Bossner
+ *
+ * deckFile.h header file for deckFile.c
+ */
+
+#ifndef DECK_FILE_H
+#define DECK_FILE_H
+
+#include "lib.h"
+
+///////////////////////// Public Function Prototypes //////////////////////////
+
+/*
+ * Loads every card of a deck file into a deck. The file can be a text deck
+ * in the format described by load_deck_file() or a deck compiled by
+ * write_deck(). Compiled decks are mapped and used as they are without
+ * any parsing. Every card is still checked to be valid but the checksum
+ * is only checked when asked for.
+ *
+ * fileName: Name of the file that contains the deck
+ *
+ * deck: deck the cards are loaded into. Must be closed with close_deck()
+ *
+ * verify: true to check the checksum of a compiled deck
+ *
+ * return: returns VALID if the deck was loaded, CANNOT_OPEN_DECK if the
+ *         file could not be read or INVALID_DECK if it is not a valid deck
+ */
+int open_deck(char* fileName, Deck* deck, bool verify);
+
+/*
+ * Frees or unmaps the cards of a deck
+ *
+ * deck: deck to close
+ */
+void close_deck(Deck* deck);
+
+/*
+ * Compiles a deck into a file that open_deck() can map straight into
+ * memory. The file only works on machines with the same Card layout which
+ * is checked by open_deck().
+ *
+ * fileName: Name of the file to write the deck to
+ *
+ * deck: deck to compile
+ *
+ * return: returns false if the file could not be written else true
+ */
+bool write_deck(char* fileName, Deck* deck);
+
+/*
+ * Hashes the cards of a deck with 64 bit FNV-1a
+ *
+ * deck: deck to hash
+ *
+ * return: returns the hash of the cards
+ */
+unsigned long long deck_checksum(Deck* deck);
+
+#endif
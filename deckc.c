@@ -0,0 +1,58 @@
+/* deckc.c
+ *
+ * Author: Michael Bossner
+ *
+ * deckc.c is the main file for the deck compiler. It checks a deck file and
+ * compiles it into a deck that austerity can map without parsing.
+ *
+ * Usage: deckc deck [compiled]
+ *
+ * With only a deck the deck is checked, including the checksum of a
+ * compiled deck, and the number of cards and checksum are printed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "deckFile.h"
+#include "lib.h"
+#include "endAusterity.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define MIN_ARGS 2
+#define MAX_ARGS 3
+#define ARGV_DECK 1
+#define ARGV_COMPILED 2
+#define CANNOT_WRITE_DECK 5
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int main(int argc, char** argv) {
+    Deck deck;
+    int status;
+
+    if (!is_num_args_valid(argc, MIN_ARGS, MAX_ARGS)) {
+        fprintf(stderr, "Usage: deckc deck [compiled]\n");
+        return WRONG_NUM_ARGS;
+    }
+
+    status = open_deck(argv[ARGV_DECK], &deck, true);
+    if (status == CANNOT_OPEN_DECK) {
+        fprintf(stderr, "Cannot access deck file\n");
+        return status;
+    } else if (status == INVALID_DECK) {
+        fprintf(stderr, "Invalid deck file contents\n");
+        return status;
+    }
+
+    if (argc == MAX_ARGS && !write_deck(argv[ARGV_COMPILED], &deck)) {
+        fprintf(stderr, "Cannot write compiled deck\n");
+        close_deck(&deck);
+        return CANNOT_WRITE_DECK;
+    }
+    printf("%d cards checksum %016llx\n", deck.size, deck_checksum(&deck));
+    close_deck(&deck);
+
+    return 0;
+}
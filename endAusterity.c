@@ -5,12 +5,18 @@
  * endAusterity.c contains functions related to ending austerity
  */
 
+#define _GNU_SOURCE // ppoll
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <sys/wait.h>
 #include <signal.h>
 #include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <fcntl.h>
 
 #include "endAusterity.h"
 #include "deck.h"
@@ -18,10 +24,8 @@
 #include "lib.h"
 #include "game.h"
 #include "comms.h"
-
-/////////////////////////////////// Defines ///////////////////////////////////
-
-#define SLEEP 2
+#include "broadcast.h"
+#include "loop.h"
 
 //////////////////////// Private Functions Prototypes /////////////////////////
 
@@ -55,16 +59,22 @@ static void wrong_num_args(void);
 static void invalid_args(void);
 
 /*
- * The deck file provided cannot be accessed
- * prints a message explaining
+ * The deck file provided cannot be accessed or a streamed deck could not 
+ * be read again for the next game
+ * kills any players already started and prints a message explaining
+ *
+ * state: Contains all information needed to keep track of the game
  */
-static void cannot_access_deck(void);
+static void cannot_access_deck(GameState* state);
 
 /*
  * the contents of the deck file file are invalid
- * prints a message explaining
+ * kills any players already started when a streamed deck is found to be
+ * invalid while playing and prints a message explaining
+ *
+ * state: Contains all information needed to keep track of the game
  */
-static void invalid_deck(void);
+static void invalid_deck(GameState* state);
 
 /*
  * Failed to start a player process
@@ -99,27 +109,81 @@ static void protocol_error(GameState* state);
 static void sigint_caught(GameState* state);
 
 /*
- * sends the end of game message to all players.
- * if players have not ended within 2 seconds SIGKILL will be sent
+ * sends the end of game message to all players then waits for them to exit.
+ * Waiting ends as soon as the last player has been reaped. If players have
+ * not ended within the grace time SIGKILL will be sent. Plugin players,
+ * daemon players and players that were never started have no process and
+ * are skipped. At one of many tables nothing is waited for. The message is
+ * written without blocking and reap_table() does the rest while the other
+ * tables play
  *
  * state: Contains all information needed to keep track of the game
  */
 static void kill_children(GameState* state);
 
 /*
- * closes all communications with players
+ * sends SIGKILL to every player process of the table that has not been
+ * reaped yet
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+static void kill_leftovers(GameState* state);
+
+/*
+ * stops writes to the players of the table from blocking so a player that
+ * is not reading can not hold up the other tables
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+static void stop_blocking(GameState* state);
+
+/*
+ * checks if any player process of the table has not been reaped by the
+ * SIGCHLD handler yet. Plugin players, daemon players and players that were
+ * never started have no process and are skipped
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * return: returns true if a player process is still running else false
+ */
+static bool has_live_children(GameState* state);
+
+/*
+ * checks if a child has been reaped by the SIGCHLD handler
+ *
+ * child: process ID of the child
+ *
+ * return: returns true if the child has exited else false
+ */
+static bool is_child_dead(pid_t child);
+
+/*
+ * closes all communications with players and unloads all player plugins.
+ * Players are taken out of the event loop first as it is shared with the
+ * other tables
  *
  * state: Contains all information needed to keep track of the game
  */
 static void close_pipes(GameState* state);
 
 /*
- * prints the exit status of all children if the status is not 0
+ * prints the exit status of all children if the status is not 0. While the
+ * players of an ended table are given time to exit this is left for
+ * reap_table() to do
  *
  * state: Contains all information needed to keep track of the game
  */
 static void print_status(GameState* state);
 
+/*
+ * prints statistics about the hub to stderr. For each player how long they
+ * took to start, how many replies they sent to dowhat, how long they took
+ * and how many times they ran out of time
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+static void print_stats(GameState* state);
+
 ////////////////////////////////// Functions //////////////////////////////////
 
 void end_austerity(GameState* state, int exitStatus) {
@@ -134,10 +198,10 @@ void end_austerity(GameState* state, int exitStatus) {
             invalid_args();
             break;
         case CANNOT_OPEN_DECK:
-            cannot_access_deck();
+            cannot_access_deck(state);
             break;
         case INVALID_DECK:
-            invalid_deck();
+            invalid_deck(state);
             break;
         case BAD_START:
             bad_start(state);
@@ -158,16 +222,57 @@ void end_austerity(GameState* state, int exitStatus) {
     free_deck(state);   
     close_pipes(state);
 
+    if (state->tableEnd != NULL) { // only this table ends
+        state->progress.ended = true;
+        state->progress.status = exitStatus;
+        longjmp(*state->tableEnd, 1);
+    }
     exit(exitStatus);
 }
 
+bool reap_table(GameState* state) {
+    if (state->progress.killAt == 0) {
+        return true;
+    } else if (has_live_children(state) && 
+            time_now_us() < state->progress.killAt) {
+        return false;
+    }
+    kill_leftovers(state);
+    state->progress.killAt = 0;
+    if (state->progress.statusDue) {
+        print_status(state);
+        fflush(stderr);
+    }
+    return true;
+}
+
+bool is_bad_start(GameState* state) {
+    for (int player = 0; player < state->player.count; player++) {
+        for (int dead = 0; dead < sigStore.index; dead++) {
+            if (state->player.pidList[player] > 0 && 
+                    sigStore.children[dead] == 
+                    state->player.pidList[player] &&
+                    sigStore.status[dead] == BAD_CHILD) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 ////////////////////////////// Private Functions //////////////////////////////
 //
 static void game_over(GameState* state) {
     char* winners = "Winner(s) ";
     kill_children(state);
     print_status(state);
+    print_table(state, stdout);
     print_winners(state, winners, stdout);
+    if (state->config.stats) {
+        print_stats(state);
+        print_table(state, stderr);
+        print_traffic(state);
+    }
     fflush(stderr);
 }
 
@@ -185,13 +290,17 @@ static void invalid_args(void) {
 }
 
 //
-static void cannot_access_deck(void) {
+static void cannot_access_deck(GameState* state) {
+    kill_children(state);
+    print_table(state, stderr);
     fprintf(stderr, "%s\n", "Cannot access deck file");
     fflush(stderr);
 }
 
 //
-static void invalid_deck(void) {
+static void invalid_deck(GameState* state) {
+    kill_children(state);
+    print_table(state, stderr);
     fprintf(stderr, "%s\n", "Invalid deck file contents");
     fflush(stderr);
 }
@@ -199,6 +308,7 @@ static void invalid_deck(void) {
 //
 static void bad_start(GameState* state) {
     kill_children(state);
+    print_table(state, stderr);
     fprintf(stderr, "%s\n", "Bad start");
     fflush(stderr);
 }
@@ -207,8 +317,10 @@ static void bad_start(GameState* state) {
 static void client_disconnected(GameState* state) {
     kill_children(state);       
     print_status(state);
+    print_table(state, stdout);
     fprintf(stdout, "%s\n", "Game ended due to disconnect");
     fflush(stdout);
+    print_table(state, stderr);
     fprintf(stderr, "%s\n", "Client disconnected");
     fflush(stderr);
 }
@@ -217,6 +329,7 @@ static void client_disconnected(GameState* state) {
 static void protocol_error(GameState* state) {
     kill_children(state);
     print_status(state);
+    print_table(state, stderr);
     fprintf(stderr, "%s\n", "Protocol error by client");
     fflush(stderr);
 }
@@ -224,47 +337,112 @@ static void protocol_error(GameState* state) {
 //
 static void sigint_caught(GameState* state) {
     kill_children(state);
+    print_table(state, stderr);
     fprintf(stderr, "%s\n", "SIGINT caught");
     fflush(stderr);
 }
 
 //
 static void kill_children(GameState* state) {
-    int sleepTime = SLEEP;
+    sigset_t childMask;
+    sigset_t oldMask;
+    long long deadline = time_now_us() + 
+            ((long long)state->config.graceTime * US_PER_MS);
+
+    if (state->tableEnd != NULL) {
+        stop_blocking(state);
+    }
+    broadcast(state, &(Record){.type = WIRE_EOG});
+    flush_players(state);
+    if (state->tableEnd != NULL) { // waited for by reap_table()
+        state->progress.killAt = deadline;
+        return;
+    }
+
+    // SIGCHLD is blocked while checking the children and only let through
+    // while waiting so an exit can not slip in between the two
+    sigemptyset(&childMask);
+    sigaddset(&childMask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &childMask, &oldMask);
+    while (has_live_children(state)) {
+        long long timeLeft = deadline - time_now_us();
+        if (timeLeft <= 0) {
+            break;
+        }
+        struct timespec timeout = {timeLeft / US_PER_SEC, 
+                (timeLeft % US_PER_SEC) * MS_PER_SEC};
+        ppoll(NULL, 0, &timeout, &oldMask);
+    }
+    sigprocmask(SIG_SETMASK, &oldMask, NULL);
+    kill_leftovers(state);
+}
+
+//
+static void kill_leftovers(GameState* state) {
     for (int player = 0; player < state->player.count; player++) {
-        fprintf(state->player.commsList[player][WRITE], "eog\n");
-        fflush(state->player.commsList[player][WRITE]);
+        if (state->player.pidList[player] > 0 && 
+                !is_child_dead(state->player.pidList[player])) {
+            kill(state->player.pidList[player], SIGKILL);
+        }
     }
+}
 
-    while (sleepTime > 0 && (sigStore.index != state->player.count)) {
-        sleepTime = sleep(sleepTime);
+//
+static void stop_blocking(GameState* state) {
+    for (int player = 0; player < state->player.count; player++) {
+        if (state->player.commsList[player][WRITE] != NULL) {
+            int fd = fileno(state->player.commsList[player][WRITE]);
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        }
     }
+}
 
+//
+static bool has_live_children(GameState* state) {
     for (int player = 0; player < state->player.count; player++) {
-        for (int dead = 0; dead < sigStore.index; dead++) {
-            if (state->player.pidList[player] == sigStore.children[dead]) {
-                break;
-            } else if (dead == (sigStore.index - 1)) {
-                kill(state->player.pidList[player], SIGKILL);
-            }
+        // plugins, daemons and unstarted players are 0
+        if (state->player.pidList[player] > 0 && 
+                !is_child_dead(state->player.pidList[player])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//
+static bool is_child_dead(pid_t child) {
+    for (int dead = 0; dead < sigStore.index; dead++) {
+        if (sigStore.children[dead] == child) {
+            return true;
         }
     }
+    return false;
 }
 
 //
 static void close_pipes(GameState* state) {
+    unwatch_players(state->loop, state);
     for (int player = 0; player < state->player.count; player++) {      
-        fclose(state->player.commsList[player][READ]);
-        fclose(state->player.commsList[player][WRITE]);
+        if (state->player.plugins[player] != NULL) {
+            dlclose(state->player.plugins[player]);
+        } else if (state->player.commsList[player][READ] != NULL) {
+            fclose(state->player.commsList[player][READ]);
+            fclose(state->player.commsList[player][WRITE]);
+        }
     }
 }
 
 //
 static void print_status(GameState* state) {
+    if (state->progress.killAt > 0) {
+        state->progress.statusDue = true;
+        return;
+    }
     for (int player = 0; player < state->player.count; player++) {
-        for (int i = 0; i < state->player.count; i++) {
+        for (int i = 0; i < sigStore.index; i++) {
             if (sigStore.children[i] == state->player.pidList[player]) {
                 if (sigStore.status[i] != 0) {
+                    print_table(state, stderr);
                     if (sigStore.childSignaled) {
                         fprintf(stderr, "Player %c shutdown after receiving " 
                                 "signal %d\n", 
@@ -281,4 +459,32 @@ static void print_status(GameState* state) {
             }
         }
     }
+}
+
+//
+static void print_stats(GameState* state) {
+    for (int player = 0; player < state->player.count; player++) {
+        print_table(state, stderr);
+        fprintf(stderr, "Player %c started in %lldus and was ready after "
+                "%lldus\n",
+                player_int_to_char(player),
+                state->clock.spawn[player],
+                state->clock.ready[player]);
+    }
+    for (int player = 0; player < state->player.count; player++) {
+        long long average = 0;
+        if (state->clock.replies[player] > 0) {
+            average = state->clock.total[player] / 
+                    state->clock.replies[player];
+        }
+        print_table(state, stderr);
+        fprintf(stderr, "Player %c replied %d times in %lldus "
+                "(average %lldus, longest %lldus, %d timeouts)\n",
+                player_int_to_char(player),
+                state->clock.replies[player],
+                state->clock.total[player],
+                average,
+                state->clock.longest[player],
+                state->clock.timeouts[player]);
+    }
 }
\ No newline at end of file
@@ -29,7 +29,9 @@ enum End {
 ///////////////////////// Public Function Prototypes //////////////////////////
 
 /*
- * Controls the ending of the Austerity program
+ * Controls the ending of the Austerity program. If the game is at one of
+ * many tables only that table is ended and play goes back to play_tables()
+ * instead of exiting.
  *
  * state: Contains all information needed to keep track of the game
  *
@@ -55,4 +57,26 @@ enum End {
  */
 void end_austerity(GameState* state, int exitStatus);
 
+/*
+ * Finishes ending a table that end_austerity() ended. Its players are given
+ * the grace time to exit while the other tables keep playing. Players still
+ * running after it are sent SIGKILL.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * return: returns true once no player of the table is left to wait for
+ *         else false
+ */
+bool reap_table(GameState* state);
+
+/*
+ * Checks if a player process of the table failed to exec. Children of
+ * other tables are not counted.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * return: returns true if a player ended with status 11 else false
+ */
+bool is_bad_start(GameState* state);
+
 #endif
\ No newline at end of file
@@ -9,30 +9,30 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include "game.h"
 #include "lib.h"
 #include "board.h"
 #include "deck.h"
+#include "token.h"
 #include "endAusterity.h"
 #include "comms.h"
 #include "card.h"
-#include "token.h"
+#include "rules.h"
+#include "loop.h"
+#include "broadcast.h"
+#include "wire.h"
+
+////////////////////////////// Global Variables ///////////////////////////////
+
+SigStore sigStore;
 
 /////////////////////////////////// Defines ///////////////////////////////////
 
 #define PROTOCOL_ERR_MAX 2
-#define TOKENS_WILD 5
 #define TAKE_MIN 11
 
-/* All actions the hub can receive from the player*/
-enum DoWhat {
-    INVALID_MESSAGE,
-    WILD,
-    PURCHASE,
-    TAKE,
-};
-
 /* Used for indexing into a wild action message*/
 enum Wild {
     WILD_W,
@@ -67,13 +67,55 @@ enum Take {
 //////////////////////// Private Functions Prototypes /////////////////////////
 
 /*
- * Starts the game by sending the tokens message then drawing up to 8 cards
- * to the board from the deck. May be less if the deck size is smaller than 8.
+ * Starts the game by sending the markets message if the board is not the
+ * default size and the tokens message, then drawing cards to fill the board
+ * from the deck. May be less if the deck size is smaller than the board.
  *
  * state: Contains all information needed to keep track of the game
  */
 static void game_start(GameState* state);
 
+/*
+ * Starts a game at a table and the turn of the first player
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+static void begin_game(GameState* state);
+
+/*
+ * Moves a table of play_tables() on by one step without waiting. The next
+ * game is started, a finished game is ended, a plugin takes its turn or a
+ * player who has run out of time has the timeout policy applied.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * Error 7: Protocol error by player
+ */
+static void advance_table(GameState* state);
+
+/*
+ * Works out how many milliseconds the event loop may wait before a table
+ * has to be moved on again. An ended table has to be moved on when its
+ * players are due to be killed
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * return: Returns NO_TIMEOUT if the table is only waiting for a player
+ *         with no time limit. Else the milliseconds that may be waited
+ */
+static int table_timeout(GameState* state);
+
+/*
+ * Picks the shorter of two timeouts
+ *
+ * first: timeout in milliseconds or NO_TIMEOUT
+ *
+ * second: timeout in milliseconds or NO_TIMEOUT
+ *
+ * return: Returns NO_TIMEOUT if both are NO_TIMEOUT else the shorter one
+ */
+static int earliest_timeout(int first, int second);
+
 /*
  * Checks to see if any signals have been flagged
  *
@@ -93,6 +135,16 @@ static void check_flags(GameState* state);
  */
 static void new_card(GameState* state);
 
+/*
+ * Takes the next card in the deck and places it on the board
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * return: returns the card placed or NULL if the deck is empty or the board
+ *         is full
+ */
+static Card* fill_market(GameState* state);
+
 /*
  * Checks if the message received is a valid action
  * Valid actions are
@@ -104,28 +156,139 @@ static void new_card(GameState* state);
  *
  * action: messaged to be checked
  *
- * return: returns 0 if action is not valid
- *         returns 1 if action is "wild"
- *         returns 2 if action is "purchase"
- *         returns 3 if action is "take"
+ * return: returns ACTION_INVALID if action is not valid
+ *         returns ACTION_WILD if action is "wild"
+ *         returns ACTION_PURCHASE if action is "purchase"
+ *         returns ACTION_TAKE if action is "take"
+ */
+static int is_action_valid(char* action);
+
+/*
+ * Starts the turn of the current player by sending them the dowhat message.
+ * If the game is over the game is marked as over instead.
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+static void start_turn(GameState* state);
+
+/*
+ * Sends the dowhat message to the player who's turn it is. The reply will
+ * arrive through handle_line(). Plugin players are not sent anything as
+ * they are asked directly by play_plugin().
  *
- * Error 6: Client disconnected. EOF received from the player
+ * state: Contains all information needed to keep track of the game
  */
-static int is_action_valid(GameState* state, char* action);
+static void send_do_what(GameState* state);
 
 /*
- * Sends the doWhat message to the player who's turn it is and waits for a
- * reply. Parses the reply and takes the corresponding action if the message
- * is valid. If an invalid messaged is received doWhat will be sent again
- * and will wait for another reply. If this message is also invalid the game
- * will exit on a protocol error.
+ * Asks the plugin of the player who's turn it is for its action and takes
+ * the action. An illegal action is treated the same as an invalid reply.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * Error 7: Protocol Error. 2 illegal actions chosen in a row
+ */
+static void play_plugin(GameState* state);
+
+/*
+ * Ends the turn of the current player after their reply if it was valid.
+ * Otherwise they are asked again and if this was their second invalid reply
+ * the game will exit on a protocol error.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * valid: whether the reply was a valid action
+ *
+ * Error 7: Protocol Error. 2 invalid messages received in a row
+ */
+static void end_reply(GameState* state, int valid);
+
+/*
+ * Checks if a player is a plugin running inside the hub
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player
+ *
+ * return: returns true if the player is a plugin else false
+ */
+static bool is_plugin(GameState* state, int player);
+
+/*
+ * Line handler for the game. Called by the event loop with every line a
+ * player sends. Only the player who's turn it is may send anything and only
+ * after they were sent dowhat. A valid reply ends their turn and starts the
+ * next one. After an invalid reply dowhat is sent again and if the second
+ * reply is also invalid the game will exit on a protocol error.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player who sent the line
+ *
+ * message: line that was sent or the record sent by a player using the
+ *          binary protocol. NULL if the player closed its pipe
+ *
+ * Error 6: Client disconnected. EOF received from any player
+ *
+ * Error 7: Protocol Error. 2 invalid messages received in a row or a player
+ *          sent a message when it was not asked to
+ */
+static void handle_line(GameState* state, int player, char* message);
+
+/*
+ * Works out how many milliseconds the current player has left to reply to
+ * dowhat under the move and total time limits.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * return: Returns NO_TIMEOUT if there is no time limit. Returns 0 if the
+ *         player is out of time else the milliseconds left
+ */
+static int time_left(GameState* state);
+
+/*
+ * Stops the current players clock and records how long they took to reply
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+static void stop_clock(GameState* state);
+
+/*
+ * The current player ran out of time. Their reply will be ignored when it
+ * arrives and the timeout policy is applied. The player either loses their
+ * turn, takes a wild token or the game ends with a protocol error.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * Error 7: Protocol Error. The timeout policy is error
+ */
+static void out_of_time(GameState* state);
+
+/*
+ * Moves the turn on to the next player and starts their turn
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+static void next_turn(GameState* state);
+
+/*
+ * Moves the turn on to the next player without starting their turn
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+static void pass_turn(GameState* state);
+
+/*
+ * Parses the reply of the player who's turn it is and takes the
+ * corresponding action if the message is valid.
  * Valid messages are
  *
  * "purchaseC:TP,TB,TY,TR,TW\n"
  * "takeTP,TB,TY,TR\n"
  * "wild\n"
  *
- * C:  Card index to be purchased. Must be an integer from 0 -> 7
+ * C:  Card index to be purchased. Must be an integer from 0 to one less
+ *     than the board size
  * TP: Purple token to be used in purchase or taken. Must be a positive int
  * TB: Brown token to be used in purchase or taken. Must be a positive int
  * TY: Yellow token to be used in purchase or taken. Must be a positive int
@@ -134,75 +297,47 @@ static int is_action_valid(GameState* state, char* action);
  *
  * state: Contains all information needed to keep track of the game
  *
- * Error 6: Client disconnected. EOF received from the player
+ * message: reply received from the player
  *
- * Error 7: Protocol Error. 2 invalid messages received in a row
+ * return: Returns 0 if the message is invalid or the action is not legal
+ *         Returns 1 if the action was taken
  */
-static void do_what(GameState* state);
+static int do_what(GameState* state, char* message);
 
 /*
- * Informs all players that the current player took a wild token
+ * Unpacks the record a player using the binary protocol replied with and
+ * takes the action if it is a purchase, take or wild. Nothing is parsed as
+ * every field is at a fixed place in the record.
  *
  * state: Contains all information needed to keep track of the game
+ *
+ * message: record received from the player
+ *
+ * return: Returns 0 if the record is not an action or the action is not
+ *         legal. Returns 1 if the action was taken
  */
-static void took_wild(GameState* state);
+static int do_record(GameState* state, char* message);
 
 /*
- * Checks if the purchase is of a valid format
- * Also does sanity checks against the current state of the game to check
- * for cheating or purchases of cards that are not on the board.
- * If the purchase is accepted card will be removed from the board and
- * the state will be updated and all players will be informed of the purchase
- * if there is another card on the deck it will be drawn to the board. 
- * format for the purchase must be
- *
- * "C:TP,TB,TY,TR,TW\n"
- *
- * C:  Card index to be purchased. Must be an integer from 0 -> 7
- * TP: Purple token to be used in purchase. Must be a positive int
- * TB: Brown token to be used in purchase. Must be a positive int
- * TY: Yellow token to be used in purchase. Must be a positive int
- * TR: Red token to be used in purchase. Must be a positive int
- * TW: wild token to be used in purchase. Must be a positive int
+ * Takes an action for the player who's turn it is if it is legal under
+ * apply_action() and informs all players of it. A purchased market is
+ * refilled from the deck if there is another card.
  *
  * state: Contains all information needed to keep track of the game
  *
- * message: message to be parsed for the purchase
+ * action: action chosen by the player
  *
- * return: Returns 0 if the message is not of the correct format
- *         Returns 0 if there is no card on the board where the index asks for
- *         Returns 0 if the player trys to buy a card with less tokens then
- *         they have
- *         Returns 1 if the purchase succeeds
+ * return: Returns 0 if the action is not legal
+ *         Returns 1 if the action was taken
  */
-static int purchased(GameState* state, char* message);
+static int do_action(GameState* state, Action* action);
 
 /*
- * Checks if the take is of a valid format
- * Also does sanity checks against the current state of the game to check
- * for cheating or asking to take from empty piles.
- * If the take is accepted the coins will be removed from the token pile and
- * given to the player. All players will then be informed of the take action. 
- * format for the take must be
- *
- * "TP,TB,TY,TR\n"
- *
- * TP: Purple tokens to be taken. Must be a positive int
- * TB: Brown tokens to be taken. Must be a positive int
- * TY: Yellow tokens to be taken. Must be a positive int
- * TR: Red tokens to be taken. Must be a positive int
- *
- * cannot take more than 3 coins || if the token pile has less than 3 tokens
+ * Informs all players that the current player took a wild token
  *
  * state: Contains all information needed to keep track of the game
- *
- * message: message to be parsed for the take
- *
- * return: Returns 0 if the message is not of the correct format or if the
- *         action fails a sanity check.
- *         Returns 1 if the take succeeds
  */
-static int took(GameState* state, char* message);
+static void print_wild(GameState* state);
 
 /*
  * Prints the tokens message to all players
@@ -214,11 +349,13 @@ static void tokens(GameState* state);
 /*
  * checks if the game is over either by the board running out of card for
  * purchase or the victory score has been reached and all player have had
- * there turn. if true austerity will begin shut down.
+ * there turn.
  *
  * state: Contains all information needed to keep track of the game
+ *
+ * return: Returns true if the game is over else false
  */
-static void is_game_over(GameState* state);
+static bool is_game_over(GameState* state);
 
 /*
  * Prints the purchased message to all players
@@ -244,33 +381,177 @@ static void print_take(GameState* state, long* tokens);
 
 void game_loop(GameState* state) {
     check_flags(state);
-    game_start(state);
-    FOREVER {
+    begin_game(state);
+    while (!state->progress.over) {
+        if (is_plugin(state, state->currentPlayer)) {
+            play_plugin(state);
+        } else {
+            run_loop(state->loop, time_left(state));
+        }
         check_flags(state);
-        is_game_over(state);
+        if (state->progress.waiting && time_left(state) == 0) {
+            out_of_time(state);
+        }
+    }
+}
 
-        do_what(state);
+void headless_game(GameState* state) {
+    Action action;
 
-        if (state->currentPlayer == state->player.count - 1) {
-            state->currentPlayer = 0;
-        } else {
-            state->currentPlayer++;
+    for (int i = 0; i < state->board.size; i++) {
+        fill_market(state);
+    }
+    while (!is_game_over(state)) {
+        const int player = state->currentPlayer;
+        int invalid = 0;
+
+        check_flags(state);
+        do { // same chances as a player that is asked again
+            if (invalid == PROTOCOL_ERR_MAX) {
+                end_austerity(state, PROTOCOL_ERR);
+            }
+            state->player.strategies[player](state, &action);
+            state->clock.replies[player]++;
+            invalid++;
+        } while (apply_action(state, player, &action, NULL) != RULE_APPLIED);
+        if (action.type == ACTION_PURCHASE) {
+            fill_market(state);
         }
+        pass_turn(state);
     }
 }
 
+void play_tables(GameState* tables, int count) {
+    jmp_buf tableEnd;
+    int running;
+
+    for (int table = 0; table < count; table++) {
+        tables[table].tableEnd = &tableEnd;
+        tables[table].game = 1;
+        tables[table].progress.playing = false;
+    }
+    setjmp(tableEnd); // every table that ends comes back to here
+    do {
+        int timeout = NO_TIMEOUT;
+
+        running = 0;
+        for (int table = 0; table < count; table++) {
+            GameState* state = &tables[table];
+            if (state->progress.ended) {
+                if (!reap_table(state)) { // players still have time to exit
+                    timeout = earliest_timeout(timeout, table_timeout(state));
+                    running++;
+                }
+                continue;
+            }
+            check_flags(state); // ends every table one after the other
+            advance_table(state);
+            timeout = earliest_timeout(timeout, table_timeout(state));
+            running++;
+        }
+        if (running > 0) { // lines are handed to the table they belong to
+            run_loop(tables[0].loop, timeout);
+        }
+    } while (running > 0);
+}
+
+void reset_game(GameState* state) {
+    init_board(state);
+    init_tokens(state);
+
+    state->currentPlayer = 0;
+
+    for (int player = 0; player < MAX_PLAYERS; player++) {
+        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+            state->player.discountList[player][colour] = 0;
+            state->player.tokens[player][colour] = 0;
+
+        }
+        state->player.scoreCard[player] = 0;
+        state->player.wildPile[player] = 0;
+        state->clock.spent[player] = 0;
+    }
+}
+
+void next_game(GameState* state) {
+    char* winners = "Winner(s) ";
+    print_table(state, stdout);
+    print_winners(state, winners, stdout);
+    if (!state->config.headless) {
+        fflush(stdout);
+    }
+
+    broadcast(state, &(Record){.type = WIRE_NEWGAME});
+}
+
 ////////////////////////////// Private Functions //////////////////////////////
 //
 static void game_start(GameState* state) {
+    if (state->board.size != DEFAULT_MARKETS) { // players assume the default
+        broadcast(state, &(Record){.type = WIRE_MARKETS, 
+                .values = {state->board.size}});
+    }
     tokens(state);
-    for (int i = 0; i < MAX_MARKETS; i++) {
+    for (int i = 0; i < state->board.size; i++) {
         new_card(state);
     }
 }
 
+//
+static void begin_game(GameState* state) {
+    state->lineHandler = handle_line;
+    state->progress.waiting = false;
+    state->progress.over = false;
+    state->progress.playing = true;
+
+    game_start(state);
+    start_turn(state);
+}
+
+//
+static void advance_table(GameState* state) {
+    if (!state->progress.playing) {
+        begin_game(state);
+    } else if (state->progress.over) {
+        if (state->game == state->config.games) {
+            end_austerity(state, GAME_OVER);
+        }
+        next_game(state);
+        free_board(state);
+        reset_game(state);
+        rewind_deck(state);
+        state->game++;
+        state->progress.playing = false;
+    } else if (is_plugin(state, state->currentPlayer)) {
+        play_plugin(state);
+    } else if (state->progress.waiting && time_left(state) == 0) {
+        out_of_time(state);
+    }
+}
+
+//
+static int table_timeout(GameState* state) {
+    if (state->progress.ended) { // players are killed once the time is up
+        long long timeLeft = state->progress.killAt - time_now_us();
+        return (timeLeft > 0) ? (timeLeft + US_PER_MS - 1) / US_PER_MS : 0;
+    } else if (!state->progress.playing || state->progress.over || 
+            is_plugin(state, state->currentPlayer)) {
+        return 0; // the table can be moved on straight away
+    }
+    return time_left(state);
+}
+
+//
+static int earliest_timeout(int first, int second) {
+    if (first == NO_TIMEOUT || (second != NO_TIMEOUT && second < first)) {
+        return second;
+    }
+    return first;
+}
+
 //
 static void check_flags(GameState* state) {
-    if (sigStore.badStart) { // child failed to exec
+    if (is_bad_start(state)) { // child failed to exec
         end_austerity(state, BAD_START);
     } else if (sigStore.sigIntCaught) { // SIGINT fired
         end_austerity(state, SIGINT_CAUGHT);
@@ -279,25 +560,16 @@ static void check_flags(GameState* state) {
 
 //
 static void new_card(GameState* state) {
-    Card* card = state->deck.cardPile[state->deck.deckIndex];
+    Card* card = fill_market(state);
+    Record record;
 
-    if (add_to_board(state, card)) {
-        state->deck.deckIndex++;
-    } else { // no cards can be added
+    if (card == NULL) { // no cards can be added
         return;
     }
 
-    for (int player = 0; player < state->player.count; player++) {
-        fprintf(state->player.commsList[player][WRITE], 
-                "newcard%c:%ld:%ld,%ld,%ld,%ld\n",
-                card->discount,
-                card->points,
-                card->cost[PURPLE],
-                card->cost[BROWN],
-                card->cost[YELLOW],
-                card->cost[RED]);
-        fflush(state->player.commsList[player][WRITE]);
-    }
+    card_to_record(&record, card);
+    broadcast(state, &record);
+    print_table(state, stdout);
     printf("New card = Bonus %c, worth %ld, costs %ld,%ld,%ld,%ld\n", 
             card->discount,
             card->points,
@@ -305,145 +577,260 @@ static void new_card(GameState* state) {
             card->cost[BROWN],
             card->cost[YELLOW],
             card->cost[RED]);
-    fflush(stdout);
+    flush_events(state);
 }
 
 //
-static int is_action_valid(GameState* state, char* action) {
-    if (action == NULL) {
-        end_austerity(state, CLIENT_DISCONNECT);
+static Card* fill_market(GameState* state) {
+    Card* card = next_card(state);
+
+    if (card == NULL || !add_to_board(state, card)) {
+        return NULL;
     }
+    draw_card(state);
+    return check_market_card(state, market_count(state) - 1);
+}
+
+//
+static int is_action_valid(char* action) {
     int messageSize = strlen(action);
 
     if (messageSize == WILD_START) { // wild
         if (action[WILD_W] == 'w' && action[WILD_I] == 'i' && 
                 action[WILD_L] == 'l' && action[WILD_D] == 'd') {
-            return WILD;
+            return ACTION_WILD;
         }
     } else if (messageSize >= TAKE_MIN) { // other action
         if ((action[PUR_P] == 'p' && action[PUR_U] == 'u' && 
                 action[PUR_R] == 'r' && action[PUR_C] == 'c' &&
                 action[PUR_H] == 'h' && action[PUR_A] == 'a' &&
                 action[PUR_S] == 's' && action[PUR_E] == 'e')) {
-            return PURCHASE;
+            return ACTION_PURCHASE;
         } else if (action[TAKE_T] == 't' && action[TAKE_A] == 'a' &&
                 action[TAKE_K] == 'k' && action[TAKE_E] == 'e') {
-            return TAKE;
+            return ACTION_TAKE;
         }
     }
-    return FAIL;
+    return ACTION_INVALID;
 }
 
 //
-static void do_what(GameState* state) {
-    int streamEnd = 0;
-    char* message;
-    int action;
-
-    for (int protocolError = 0; protocolError < PROTOCOL_ERR_MAX; 
-            protocolError++) {
-
-        fprintf(state->player.commsList[state->currentPlayer][WRITE], 
-                "dowhat\n");
-        fflush(state->player.commsList[state->currentPlayer][WRITE]);
-
-        message = rec_message( // wait for message from player
-                state->player.commsList[state->currentPlayer][READ], 
-                &streamEnd);
-        action = is_action_valid(state, message);
-        
-        switch (action) {
-            case INVALID_MESSAGE:               
-                break;
-            case WILD:
-                took_wild(state);
-                free(message);
-                return;
-            case PURCHASE:
-                if(purchased(state, &message[PUR_START])) {
-                    free(message);
-                    return;
-                } else {
-                    break;
-                }
-            case TAKE:
-                if(took(state, &message[TAKE_START])) {
-                    free(message);
-                    return;
-                } else {
-                    break;
-                }
-        }
-        free(message);
+static void start_turn(GameState* state) {
+    if (is_game_over(state)) {
+        state->progress.over = true;
+        return;
     }
-    end_austerity(state, PROTOCOL_ERR);
+    state->progress.invalidMessages = 0;
+    send_do_what(state);
 }
 
 //
-static void took_wild(GameState* state) {
-    state->player.wildPile[state->currentPlayer]++;
+static void send_do_what(GameState* state) {
+    send_record(state, state->currentPlayer, &(Record){.type = WIRE_DOWHAT});
+    flush_player(state, state->currentPlayer);
+    state->progress.waiting = true;
+    state->clock.turnStart = time_now_us();
+}
 
-    for (int player = 0; player < state->player.count; player++) {
-        fprintf(state->player.commsList[player][WRITE], 
-                "wild%c\n", player_int_to_char(state->currentPlayer));
-        fflush(state->player.commsList[player][WRITE]);
+//
+static void play_plugin(GameState* state) {
+    Action action;
+
+    state->player.strategies[state->currentPlayer](state, &action);
+    state->progress.waiting = false;
+    stop_clock(state);
+    end_reply(state, do_action(state, &action));
+}
+
+//
+static void end_reply(GameState* state, int valid) {
+    if (valid) { // turn is over
+        next_turn(state);
+    } else if (++state->progress.invalidMessages < PROTOCOL_ERR_MAX) {
+        send_do_what(state); // one more chance
+    } else {
+        end_austerity(state, PROTOCOL_ERR);
     }
+}
 
-    printf("Player %c took a wild\n", 
-            player_int_to_char(state->currentPlayer));
-    fflush(stdout);
+//
+static bool is_plugin(GameState* state, int player) {
+    return state->player.strategies[player] != NULL;
+}
+
+//
+static void handle_line(GameState* state, int player, char* message) {
+    if (message == NULL) {
+        end_austerity(state, CLIENT_DISCONNECT);
+    } else if (state->clock.late[player] > 0) { // reply after running out 
+        state->clock.late[player]--;           // of time
+        return;
+    } else if (player != state->currentPlayer || !state->progress.waiting) {
+        end_austerity(state, PROTOCOL_ERR); // player was not asked
+    }
+    state->progress.waiting = false;
+    stop_clock(state);
+    if (state->player.binary[player]) {
+        end_reply(state, do_record(state, message));
+    } else {
+        end_reply(state, do_what(state, message));
+    }
 }
 
 //
-static int purchased(GameState* state, char* message) {
-    Card* card;
-    long tokens[TOKENS_WILD];
-    char* mesIndex = message;
-    int boardIndex;
+static void next_turn(GameState* state) {
+    state->traffic.turns++;
+    pass_turn(state);
+    start_turn(state);
+}
 
-    if(!is_valid_purchase(tokens, mesIndex, &boardIndex)) {
-        return FAIL;
-    } else if ((card = check_market_card(state, boardIndex)) == NULL) {
-        return FAIL; // no card at board index
+//
+static void pass_turn(GameState* state) {
+    if (state->currentPlayer == state->player.count - 1) {
+        state->currentPlayer = 0;
     } else {
+        state->currentPlayer++;
+    }
+}
 
-        if (!purchase_sanity_check(state, tokens, card)) {
-            return FAIL; // not a legal purchase
-        }
+//
+static int time_left(GameState* state) {
+    if (!state->progress.waiting || (state->config.moveTime == 0 && 
+            state->config.totalTime == 0)) {
+        return NO_TIMEOUT;
+    }
+    long long used = time_now_us() - state->clock.turnStart;
+    long long left = LLONG_MAX;
 
-        purchase_card(state, boardIndex);
-        // update state
-        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
-            state->player.tokens[state->currentPlayer][colour] -= 
-                    tokens[colour];
-            state->tokenPile.pile[colour] += tokens[colour];
+    if (state->config.moveTime > 0) {
+        left = ((long long)state->config.moveTime * US_PER_MS) - used;
+    }
+    if (state->config.totalTime > 0) {
+        long long totalLeft = ((long long)state->config.totalTime * 
+                US_PER_MS) - state->clock.spent[state->currentPlayer] - used;
+        if (totalLeft < left) {
+            left = totalLeft;
         }
-        state->player.wildPile[state->currentPlayer] -= tokens[WILD_START];
-        add_discount(state, card->discount, state->currentPlayer);
-        state->player.scoreCard[state->currentPlayer] += card->points;
     }
+    if (left <= 0) {
+        return 0;
+    }
+    return (left + US_PER_MS - 1) / US_PER_MS; // round up so we never wake
+}                                              // up before the limit
+
+//
+static void stop_clock(GameState* state) {
+    const int player = state->currentPlayer;
+    long long used = time_now_us() - state->clock.turnStart;
+
+    state->clock.spent[player] += used;
+    state->clock.total[player] += used;
+    state->clock.replies[player]++;
+    if (used > state->clock.longest[player]) {
+        state->clock.longest[player] = used;
+    }
+}
+
+//
+static void out_of_time(GameState* state) {
+    state->progress.waiting = false;
+    stop_clock(state);
+    state->clock.timeouts[state->currentPlayer]++;
+    state->clock.late[state->currentPlayer]++;
+
+    switch (state->config.timeoutPolicy) {
+        case TIMEOUT_FORFEIT:
+            print_table(state, stdout);
+            printf("Player %c ran out of time\n", 
+                    player_int_to_char(state->currentPlayer));
+            flush_events(state);
+            next_turn(state);
+            break;
+        case TIMEOUT_WILD:
+            do_action(state, &(Action){.type = ACTION_WILD});
+            next_turn(state);
+            break;
+        default:
+            end_austerity(state, PROTOCOL_ERR);
+    }
+}
+
+//
+static int do_what(GameState* state, char* message) {
+    Action action;
+
+    switch (action.type = is_action_valid(message)) {
+        case ACTION_WILD:
+            break;
+        case ACTION_PURCHASE:
+            if (!is_valid_purchase(action.tokens, &message[PUR_START], 
+                    &action.boardIndex)) {
+                return FAIL;
+            }
+            break;
+        case ACTION_TAKE:
+            if (!is_valid_take(action.tokens, &message[TAKE_START])) {
+                return FAIL;
+            }
+            break;
+        default:
+            return FAIL;
+    }
+    return do_action(state, &action);
+}
+
+//
+static int do_record(GameState* state, char* message) {
+    Record record;
+    Action action;
 
-    print_purchased(state, boardIndex, tokens); 
-    new_card(state);
+    if (!decode_record(message, &record) || 
+            !record_to_action(&record, &action)) {
+        return FAIL;
+    }
+    return do_action(state, &action);
+}
 
+//
+static int do_action(GameState* state, Action* action) {
+    if (apply_action(state, state->currentPlayer, action, NULL) != 
+            RULE_APPLIED) {
+        return FAIL;
+    }
+    switch (action->type) {
+        case ACTION_WILD:
+            print_wild(state);
+            break;
+        case ACTION_PURCHASE:
+            print_purchased(state, action->boardIndex, action->tokens);
+            new_card(state);
+            break;
+        case ACTION_TAKE:
+            print_take(state, action->tokens);
+            break;
+    }
     return VALID;
 }
 
+//
+static void print_wild(GameState* state) {
+    broadcast(state, &(Record){.type = WIRE_WILD, 
+            .player = state->currentPlayer});
+
+    print_table(state, stdout);
+    printf("Player %c took a wild\n", 
+            player_int_to_char(state->currentPlayer));
+    flush_events(state);
+}
+
 //
 static void print_purchased(GameState* state, int boardIndex, long* tokens) {
-    for (int player = 0; player < state->player.count; player++) {
-        fprintf(state->player.commsList[player][WRITE], 
-                "purchased%c:%d:%ld,%ld,%ld,%ld,%ld\n", 
-                player_int_to_char(state->currentPlayer),
-                boardIndex,
-                tokens[PURPLE],
-                tokens[BROWN],
-                tokens[YELLOW],
-                tokens[RED],
-                tokens[WILD_START]);
-        fflush(state->player.commsList[player][WRITE]);
-    }
+    broadcast(state, &(Record){.type = WIRE_PURCHASED, 
+            .player = state->currentPlayer, .market = boardIndex, 
+            .values = {tokens[PURPLE], tokens[BROWN], tokens[YELLOW], 
+            tokens[RED], tokens[WILD_START]}});
 
+    print_table(state, stdout);
     printf("Player %c purchased %d using %ld,%ld,%ld,%ld,%ld\n", 
             player_int_to_char(state->currentPlayer),
             boardIndex,
@@ -452,71 +839,41 @@ static void print_purchased(GameState* state, int boardIndex, long* tokens) {
             tokens[YELLOW],
             tokens[RED],
             tokens[WILD_START]);
-    fflush(stdout);
-}
-
-//
-static int took(GameState* state, char* message) {
-    long tokens[MAX_TOKEN_COLOUR];
-    char* mesIndex = message;
-
-    if (!is_valid_take(tokens, mesIndex)) {
-        return FAIL;
-    } else if (!take_sanity_check(state, tokens)) {
-        return FAIL; // not a legal take
-    } else { // update state
-        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
-            state->tokenPile.pile[colour] -= tokens[colour];
-            state->player.tokens[state->currentPlayer][colour] += 
-                    tokens[colour];
-        }
-    }
-
-    print_take(state, tokens);  
-    return VALID;
+    flush_events(state);
 }
 
 //
 static void print_take(GameState* state, long* tokens) {
-    for (int player = 0; player < state->player.count; player++) {
-        fprintf(state->player.commsList[player][WRITE], 
-                "took%c:%ld,%ld,%ld,%ld\n", 
-                player_int_to_char(state->currentPlayer),
-                tokens[PURPLE],
-                tokens[BROWN],
-                tokens[YELLOW],
-                tokens[RED]);
-        fflush(state->player.commsList[player][WRITE]);
-    }
+    broadcast(state, &(Record){.type = WIRE_TOOK, 
+            .player = state->currentPlayer, .values = {tokens[PURPLE], 
+            tokens[BROWN], tokens[YELLOW], tokens[RED]}});
 
+    print_table(state, stdout);
     printf("Player %c drew %ld,%ld,%ld,%ld\n", 
             player_int_to_char(state->currentPlayer),
             tokens[PURPLE],
             tokens[BROWN],
             tokens[YELLOW],
             tokens[RED]);
-    fflush(stdout);
+    flush_events(state);
 }
 
 //
 static void tokens(GameState* state) {
-    for (int player = 0; player < state->player.count; player++) {
-
-        fprintf(state->player.commsList[player][WRITE], 
-                "tokens%d\n", state->tokenPile.maxTokens);
-        fflush(state->player.commsList[player][WRITE]);
-    }
+    broadcast(state, &(Record){.type = WIRE_TOKENS, 
+            .values = {state->tokenPile.maxTokens}});
 }
 
 //
-static void is_game_over(GameState* state) {
+static bool is_game_over(GameState* state) {
     if (is_board_empty(state)) {
-        end_austerity(state, GAME_OVER);
+        return true;
     }
     for (int player = 0; player < state->player.count; player++) {
         if (state->player.scoreCard[player] >= state->victoryPoints && 
                 state->currentPlayer == 0) { // score reached && player 0
-            end_austerity(state, GAME_OVER);
+            return true;
         }
     }
+    return false;
 }
\ No newline at end of file
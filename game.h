@@ -13,15 +13,15 @@
 ////////////////////////////// Global Variables ///////////////////////////////
 
 /* Container for all signal handling flags and information */
-SigStore sigStore;
+extern SigStore sigStore;
 
 ///////////////////////// Public Function Prototypes //////////////////////////
 
 /*
- * The game loop for the entire game. After the game starts game signal flags
+ * The game loop for a single game. After the game starts game signal flags
  * are checked then game over is checked. Then the players turn will happen
  * if all succeeds the current player will be incremented and it will all start
- * again
+ * again. Returns once the game is over.
  * 
  * state: Contains all information needed to keep track of the game
  *
@@ -35,4 +35,55 @@ SigStore sigStore;
  */
 void game_loop(GameState* state);
 
+/*
+ * Plays a single game with every player using the strategy set in 
+ * state->player.strategies. Nothing is sent or printed and no time is
+ * kept so only the outcome of the game is left in the state. Returns once
+ * the game is over.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * Error 7: Protocol error. A strategy chose 2 illegal actions in a row
+ *
+ * Error 10: Received SIGINT
+ */
+void headless_game(GameState* state);
+
+/*
+ * Plays every game of many tables at once. Each table is a separate game
+ * state with its own players but every player of every table is waited on
+ * in the same event loop so no table waits on another. A table that ends,
+ * whether its games are over or a player broke the protocol, is ended on
+ * its own with end_austerity() and the other tables keep playing while its
+ * players are given time to exit. Returns once every table has ended and
+ * all of their players are gone.
+ *
+ * tables: game state of each table. Each must have its players started and
+ *         ready or have ended while starting and share the same event loop
+ *
+ * count: number of tables
+ *
+ * Error 5: Bad Start. A player of the table failed to exec. Ends that table
+ *
+ * Error 10: Received SIGINT. Ends every table
+ */
+void play_tables(GameState* tables, int count);
+
+/*
+ * Sets the board, the token pile and every player back to how they are
+ * before the first turn of a game
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+void reset_game(GameState* state);
+
+/*
+ * Finishes a game that is not the last game of a tournament. The winners are
+ * printed and all players are sent the newgame message telling them to reset
+ * their game state rather than exit.
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+void next_game(GameState* state);
+
 #endif
\ No newline at end of file
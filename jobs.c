@@ -0,0 +1,385 @@
+/* jobs.c
+ *
+ * Author: Michael Bossner
+ *
+ * jobs.c reads a job file and runs its jobs on a pool of worker threads.
+ * Every job is a separate austerity so a game that ends in an error or
+ * never ends can not take the batch down with it.
+ */
+
+#define _GNU_SOURCE // pipe2
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "jobs.h"
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define SEPARATORS " \t\r\n"
+#define COMMENT '#'
+#define JOBS_START 64
+#define NO_JOB -1
+#define FAILED -1
+#define BAD_EXEC 127
+#define HEADLESS_OPTION "-H"
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Splits a job line into the arguments austerity is run with. The words
+ * are kept in the second half of job->line.
+ *
+ * batch: batch the job belongs to
+ *
+ * job: job to set the arguments of. job->line must be set
+ *
+ * return: returns false if memory could not be allocated else true
+ */
+static bool split_job(Batch* batch, Job* job);
+
+/*
+ * Thread function of a worker. Runs jobs until there are none left.
+ *
+ * worker: pointer to the index of the workers deque
+ *
+ * return: returns NULL
+ */
+static void* run_worker(void* worker);
+
+/*
+ * Takes the next job for a worker. Its own deque is used first and then
+ * every other deque is stolen from in turn.
+ *
+ * batch: batch being run
+ *
+ * worker: index of the worker
+ *
+ * return: returns the index of the job or NO_JOB if every deque is empty
+ */
+static int next_job(Batch* batch, int worker);
+
+/*
+ * Runs a job as austerity with stdout and stderr sent to the job output.
+ * The job is killed if it runs longer than batch->timeout.
+ *
+ * batch: batch being run
+ *
+ * job: job to run
+ */
+static void run_job(Batch* batch, Job* job);
+
+/*
+ * Reads everything austerity writes into the job output until it closes
+ * the pipe or runs out of time
+ *
+ * batch: batch being run
+ *
+ * job: job being run
+ *
+ * fd: read end of the pipe austerity writes to
+ *
+ * return: returns false if the job ran out of time else true
+ */
+static bool collect_output(Batch* batch, Job* job, int fd);
+
+/*
+ * Marks a job as finished and wakes anyone waiting for it
+ *
+ * batch: batch being run
+ *
+ * job: job that finished
+ */
+static void finish_job(Batch* batch, Job* job);
+
+////////////////////////////// Global Variables ///////////////////////////////
+
+/* The batch passed to each worker thread with its index */
+static Batch* running;
+
+////////////////////////////////// Functions //////////////////////////////////
+
+bool read_jobs(char* fileName, Batch* batch) {
+    FILE* file = fopen(fileName, "r");
+    char* line = NULL;
+    size_t size = 0;
+    int capacity = 0;
+
+    batch->jobs = NULL;
+    batch->count = 0;
+    if (file == NULL) {
+        return false;
+    }
+    while (getline(&line, &size, file) != FAILED) {
+        char* start = &line[strspn(line, SEPARATORS)];
+
+        if (*start == '\0' || *start == COMMENT) { // nothing to run
+            continue;
+        }
+        if (batch->count == capacity) {
+            capacity = (capacity == 0) ? JOBS_START : capacity * 2;
+            Job* jobs = realloc(batch->jobs, sizeof(Job) * capacity);
+            if (jobs == NULL) {
+                break;
+            }
+            batch->jobs = jobs;
+        }
+        Job* job = &batch->jobs[batch->count];
+        int length = strcspn(start, "\r\n");
+        memset(job, 0, sizeof(Job));
+        job->status = JOB_NOT_STARTED;
+        // twice the room so split_job() can keep the words after the line
+        if ((job->line = malloc(2 * (length + 1))) == NULL) {
+            break;
+        }
+        memcpy(job->line, start, length);
+        job->line[length] = '\0';
+        if (!split_job(batch, job)) {
+            free(job->line);
+            break;
+        }
+        batch->count++;
+    }
+    free(line);
+    bool read = !ferror(file) && feof(file) && batch->count > 0;
+    fclose(file);
+    return read;
+}
+
+bool start_workers(Batch* batch) {
+    running = batch;
+    batch->steals = 0;
+    batch->threads = calloc(batch->workers, sizeof(pthread_t));
+    batch->deques = calloc(batch->workers, sizeof(JobDeque));
+    pthread_mutex_init(&batch->lock, NULL);
+    pthread_cond_init(&batch->finished, NULL);
+    if (batch->threads == NULL || batch->deques == NULL) {
+        return false;
+    }
+
+    for (int worker = 0; worker < batch->workers; worker++) {
+        JobDeque* deque = &batch->deques[worker];
+        pthread_mutex_init(&deque->lock, NULL);
+        deque->jobs = malloc(sizeof(int) *
+                (batch->count / batch->workers + 1));
+        if (deque->jobs == NULL) {
+            return false;
+        }
+        // jobs are dealt out so the first jobs are started first
+        for (int job = worker; job < batch->count; job += batch->workers) {
+            deque->jobs[deque->bottom++] = job;
+        }
+    }
+    for (int worker = 0; worker < batch->workers; worker++) {
+        if (pthread_create(&batch->threads[worker], NULL, run_worker,
+                (void*)(long)worker) != 0) {
+            batch->workers = worker; // only these need joining
+            return false;
+        }
+    }
+    return true;
+}
+
+Job* wait_for_job(Batch* batch, int index) {
+    Job* job = &batch->jobs[index];
+
+    pthread_mutex_lock(&batch->lock);
+    while (!job->done) {
+        pthread_cond_wait(&batch->finished, &batch->lock);
+    }
+    pthread_mutex_unlock(&batch->lock);
+    return job;
+}
+
+void free_batch(Batch* batch) {
+    if (batch->threads != NULL) {
+        for (int worker = 0; worker < batch->workers; worker++) {
+            pthread_join(batch->threads[worker], NULL);
+        }
+    }
+    if (batch->deques != NULL) {
+        for (int worker = 0; worker < batch->workers; worker++) {
+            free(batch->deques[worker].jobs);
+        }
+    }
+    for (int index = 0; index < batch->count; index++) {
+        free(batch->jobs[index].line);
+        free(batch->jobs[index].argv);
+        free(batch->jobs[index].output);
+    }
+    free(batch->jobs);
+    free(batch->deques);
+    free(batch->threads);
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static bool split_job(Batch* batch, Job* job) {
+    // the line can have no more words than half its length rounded up
+    int most = strlen(job->line) / 2 + 1;
+    int count = 0;
+    char* save;
+
+    // room for austerity, -H and the NULL at the end
+    if ((job->argv = malloc(sizeof(char*) * (most + 3))) == NULL) {
+        return false;
+    }
+    job->argv[count++] = batch->austerity;
+    if (batch->headless) {
+        job->argv[count++] = HEADLESS_OPTION;
+    }
+    // the words are split out of a copy so the line can still be printed
+    char* words = &job->line[strlen(job->line) + 1];
+    memcpy(words, job->line, strlen(job->line) + 1);
+    for (char* word = strtok_r(words, SEPARATORS, &save); word != NULL;
+            word = strtok_r(NULL, SEPARATORS, &save)) {
+        job->argv[count++] = word;
+    }
+    job->argv[count] = NULL;
+    return true;
+}
+
+//
+static void* run_worker(void* worker) {
+    Batch* batch = running;
+    int index;
+
+    while ((index = next_job(batch, (long)worker)) != NO_JOB) {
+        run_job(batch, &batch->jobs[index]);
+    }
+    return NULL;
+}
+
+//
+static int next_job(Batch* batch, int worker) {
+    int index = NO_JOB;
+    JobDeque* own = &batch->deques[worker];
+
+    pthread_mutex_lock(&own->lock);
+    if (own->bottom > own->top) { // oldest job is run first
+        index = own->jobs[own->top++];
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    for (int other = 1; index == NO_JOB && other < batch->workers; other++) {
+        JobDeque* victim = &batch->deques[(worker + other) % batch->workers];
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->bottom > victim->top) { // newest job is stolen
+            index = victim->jobs[--victim->bottom];
+        }
+        pthread_mutex_unlock(&victim->lock);
+        if (index != NO_JOB) {
+            pthread_mutex_lock(&batch->lock);
+            batch->steals++;
+            pthread_mutex_unlock(&batch->lock);
+        }
+    }
+    return index;
+}
+
+//
+static void run_job(Batch* batch, Job* job) {
+    int pipeFds[READ_WRITE];
+    int status;
+    pid_t child;
+
+    job->time = time_now_us();
+    if (pipe2(pipeFds, O_CLOEXEC) == FAILED) {
+        finish_job(batch, job);
+        return;
+    }
+    if ((child = fork()) == 0) { // only async signal safe calls from here
+        setpgid(0, 0); // own group so players are killed with the hub
+        dup2(pipeFds[WRITE], STDOUT_FILENO);
+        dup2(pipeFds[WRITE], STDERR_FILENO);
+        execv(job->argv[0], job->argv);
+        _exit(BAD_EXEC);
+    }
+    close(pipeFds[WRITE]);
+    if (child == FAILED) {
+        close(pipeFds[READ]);
+        finish_job(batch, job);
+        return;
+    }
+    setpgid(child, child); // also here so a timeout can not beat the child
+
+    bool inTime = collect_output(batch, job, pipeFds[READ]);
+    if (!inTime) {
+        kill(-child, SIGKILL);
+    }
+    close(pipeFds[READ]);
+    while (waitpid(child, &status, 0) == FAILED && errno == EINTR) {
+    }
+    if (!inTime) {
+        job->status = JOB_TIMED_OUT;
+    } else if (WIFEXITED(status)) {
+        job->status = WEXITSTATUS(status);
+    } else {
+        job->status = JOB_SIGNALED;
+        job->signal = WTERMSIG(status);
+    }
+    finish_job(batch, job);
+}
+
+//
+static bool collect_output(Batch* batch, Job* job, int fd) {
+    long long deadline = job->time +
+            (long long)batch->timeout * US_PER_MS;
+    struct pollfd poller = {fd, POLLIN, 0};
+
+    FOREVER {
+        int wait = -1;
+
+        if (batch->timeout > 0) {
+            long long left = deadline - time_now_us();
+            if (left <= 0) {
+                return false;
+            }
+            wait = (left + US_PER_MS - 1) / US_PER_MS;
+        }
+        int ready = poll(&poller, 1, wait);
+        if (ready == FAILED && errno != EINTR) {
+            return true;
+        } else if (ready <= 0) { // time to check the deadline again
+            continue;
+        }
+        if (job->capacity - job->length < READ_BUFFER) { // grow
+            int capacity = (job->capacity == 0) ? READ_BUFFER :
+                    job->capacity * 2;
+            char* output = realloc(job->output, capacity);
+            if (output == NULL) {
+                return true;
+            }
+            job->output = output;
+            job->capacity = capacity;
+        }
+        ssize_t got = read(fd, &job->output[job->length], READ_BUFFER);
+        if (got == 0 || (got == FAILED && errno != EINTR &&
+                errno != EAGAIN)) { // austerity and its players are done
+            return true;
+        } else if (got > 0) {
+            job->length += got;
+        }
+    }
+}
+
+//
+static void finish_job(Batch* batch, Job* job) {
+    job->time = time_now_us() - job->time;
+    pthread_mutex_lock(&batch->lock);
+    job->done = true;
+    pthread_cond_broadcast(&batch->finished);
+    pthread_mutex_unlock(&batch->lock);
+}
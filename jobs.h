@@ -0,0 +1,107 @@
+/* jobs.h
+ *
+ * Author: Michael Bossner
+ *
+ * jobs.h header file for jobs.c
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+/* Status of a job that did not exit on its own */
+#define JOB_TIMED_OUT -1
+#define JOB_SIGNALED -2
+#define JOB_NOT_STARTED -3
+
+/* A Job is one line of a job file run as a single austerity */
+typedef struct {
+    char* line; // line of the job file
+    char** argv; // arguments austerity is run with. NULL terminated
+    char* output; // everything austerity wrote to stdout and stderr
+    int length; // bytes of output
+    int capacity; // bytes the output can hold before it must grow
+    int status; // exit status of austerity or a JOB status
+    int signal; // signal that killed austerity if JOB_SIGNALED
+    long long time; // microseconds the job took
+    bool done; // the job has finished and its output is ready
+} Job;
+
+/* A JobDeque holds the jobs waiting for one worker. The worker takes jobs
+ * from the top in job order and other workers steal from the bottom once
+ * they run out so the jobs written first are finished first */
+typedef struct {
+    pthread_mutex_t lock;
+    int* jobs; // indexes of the jobs waiting
+    int top; // next job the worker takes
+    int bottom; // one past the next job to be stolen
+} JobDeque;
+
+/* A Batch is every job of a job file and the workers running them */
+typedef struct {
+    Job* jobs;
+    int count; // number of jobs
+    JobDeque* deques; // one for each worker
+    pthread_t* threads; // one for each worker
+    int workers; // number of workers
+    char* austerity; // path of austerity
+    bool headless; // run every job with -H
+    int timeout; // milliseconds a job may take. 0 for no limit
+    int steals; // jobs taken from another workers deque
+    pthread_mutex_t lock; // guards done and steals
+    pthread_cond_t finished; // signalled whenever a job finishes
+} Batch;
+
+///////////////////////// Public Function Prototypes //////////////////////////
+
+/*
+ * Reads a job file into a batch. Each line holds the arguments of one
+ * austerity separated by spaces, e.g. "-g 10 7 15 deck shenzi banzai ed".
+ * Blank lines and lines starting with '#' are skipped. batch->austerity
+ * and batch->headless must be set first.
+ *
+ * fileName: name of the job file
+ *
+ * batch: batch the jobs are read into. Must be freed with free_batch()
+ *
+ * return: returns false if the file could not be read or has no jobs
+ *         else true
+ */
+bool read_jobs(char* fileName, Batch* batch);
+
+/*
+ * Deals the jobs out to the workers in job order and starts them. Each
+ * worker runs its own jobs oldest first and then steals the newest jobs of
+ * the others until none are left.
+ *
+ * batch: batch to run. batch->workers must be set first
+ *
+ * return: returns false if the workers could not be started else true
+ */
+bool start_workers(Batch* batch);
+
+/*
+ * Waits until a job has finished
+ *
+ * batch: batch being run
+ *
+ * index: index of the job in job file order
+ *
+ * return: returns the finished job
+ */
+Job* wait_for_job(Batch* batch, int index);
+
+/*
+ * Waits for the workers to exit and frees everything in a batch
+ *
+ * batch: batch to free
+ */
+void free_batch(Batch* batch);
+
+#endif
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "lib.h"
 
@@ -41,4 +42,10 @@ char player_int_to_char(int player) {
 
 int player_char_to_int(char player) {
     return (int)NAME_CHAR_CONV(player);
+}
+
+long long time_now_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((long long)now.tv_sec * US_PER_SEC) + (now.tv_nsec / MS_PER_SEC);
 }
\ No newline at end of file
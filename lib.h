@@ -10,12 +10,17 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <setjmp.h>
 #include <unistd.h>
 #include <sys/types.h>
 
 /////////////////////////////////// Defines ///////////////////////////////////
 
 #define MAX_PLAYERS 26
+#define MAX_TABLES 256
+#define MAX_CHILDREN (MAX_PLAYERS * MAX_TABLES)
+#define MAX_MARKETS 64
+#define DEFAULT_MARKETS 8
 #define FOREVER for (;;)
 #define ZERO 48
 #define NINE 57
@@ -26,6 +31,15 @@
 #define INVALID -1
 #define FAIL 0
 #define VALID 1
+#define MS_PER_SEC 1000
+#define US_PER_MS 1000
+#define US_PER_SEC 1000000
+#define READ_BUFFER 1024
+#define DECK_MAGIC "AUSDECK"
+#define DECK_MAGIC_SIZE 8
+#define DECK_VERSION 1
+#define OUTBOX_BUFFER 4096
+#define RING_SIZE 16384 // must be a power of 2
 
 /* Indexes for token storage as well as max number of tokens */
 enum TokenIndex {
@@ -36,6 +50,40 @@ enum TokenIndex {
     MAX_TOKEN_COLOUR
 };
 
+/* The GameState is declared early so handlers can be given a pointer to it */
+typedef struct GameState GameState;
+typedef struct DeckStream DeckStream;
+
+/* Called with each line a player sends to the hub. line is NULL once the
+ * player has closed its end of the pipe */
+typedef void (*LineHandler)(GameState* state, int player, char* line);
+
+/* All actions a player can take on their turn */
+enum ActionType {
+    ACTION_INVALID,
+    ACTION_WILD,
+    ACTION_PURCHASE,
+    ACTION_TAKE,
+};
+
+/* An Action is a move a player has chosen to make on their turn */
+typedef struct {
+    int type; // see ActionType enum
+    int boardIndex; // index of the card to purchase
+    // tokens to take or to pay with. The last is the wild tokens to pay with
+    long tokens[MAX_TOKEN_COLOUR + 1];
+} Action;
+
+/* Chooses the action for the player who's turn it is. state->currentPlayer
+ * is the player choosing. The state must not be changed */
+typedef void (*DoWhat)(GameState* state, Action* action);
+
+/* Messages waiting to be written to a player when output is coalesced */
+typedef struct {
+    int length; // number of bytes waiting
+    char buffer[OUTBOX_BUFFER];
+} Outbox;
+
 /* Container for the games token pile */
 typedef struct {
     int maxTokens;
@@ -53,27 +101,118 @@ typedef struct {
 typedef struct {
     int size; // size of the deck
     int deckIndex; // current card the deck is up to
-    Card** cardPile; // pile of cards in the deck
+    Card* cards; // every card in the deck one after the other
+    // bytes of the compiled deck file cards points into. 0 if malloced
+    long mapLength;
+    DeckStream* stream; // set when the deck is read while playing
 } Deck;
 
-/* A market is set up in empty board spots and sells a single card
- * it also contains information about the markets directly next to it on
- * either side */
-typedef struct Market Market;
-struct Market {
-    Card* card; // card that the market is selling
+/* Header at the start of a compiled deck file. The cards follow straight
+ * after it as Card records laid out exactly as they are in memory */
+typedef struct {
+    char magic[DECK_MAGIC_SIZE]; // DECK_MAGIC marks a compiled deck
+    unsigned int version; // DECK_VERSION the deck was compiled with
+    unsigned int cardSize; // sizeof(Card) the deck was compiled with
+    unsigned long long count; // number of cards
+    unsigned long long checksum; // FNV-1a hash of the cards
+} DeckHeader;
+
+/* A Board stores a copy of the card each market is selling. Markets are 
+ * kept in order from the oldest (left most) at index 0 to the youngest 
+ * (right most) at index count - 1 with no gaps */
+typedef struct {
+    Card markets[MAX_MARKETS]; // card sold by each market set up
+    int count; // number of markets set up
+    int size; // most markets that can be set up. DEFAULT_MARKETS unless set
+    // cost of each market packed colour by colour for the cost kernels
+    int costs[MAX_TOKEN_COLOUR][MAX_MARKETS];
+    int wideCards; // markets with a cost too big to pack
+} Board;
+
+/* A Bell is a counter in shared memory that is rung to wake up whoever is
+ * sleeping on it with a futex */
+typedef struct {
+    unsigned int rings; // times the bell has been rung. The futex word
+    int sleepers; // number of processes sleeping on the bell
+} Bell;
+
+/* A Ring is a single producer single consumer byte queue in shared memory.
+ * head and tail only ever grow and are used modulo RING_SIZE */
+typedef struct {
+    unsigned int head; // bytes ever written. Only changed by the producer
+    unsigned int tail; // bytes ever read. Only changed by the consumer
+    int closed; // the producer will not write anything more
+    Bell data; // rung when data is written if nobody else is rung instead
+    Bell space; // rung when data is read
+    char buffer[RING_SIZE];
+} Ring;
+
+/* SharedLink is the shared memory of the shm transport. Every player has a
+ * ring in each direction */
+typedef struct {
+    Bell hubBell; // rung when a ring to the hub has data or on a signal
+    // READ rings go from the player to the hub, WRITE from hub to player
+    Ring rings[MAX_PLAYERS][READ_WRITE];
+} SharedLink;
+
+/* Checks if the process at the other end of a ring has gone away */
+typedef bool (*PeerGone)(void* peer);
+
+/* A RingEnd is one processes end of a Ring */
+typedef struct {
+    Ring* ring; // ring in shared memory. NULL if the player is not using shm
+    Bell* bell; // bell rung after writing to wake the reader
+    int spin; // microseconds to busy poll before sleeping on a bell
+    PeerGone gone; // checks if the other end has gone away while waiting
+    void* peer; // passed to gone
+} RingEnd;
+
+/* A Reader reads lines into a buffer it keeps reusing so reading a line
+ * does not allocate. Lines handed out point into the buffer and are only 
+ * valid until the next line is read */
+typedef struct {
+    int fd; // file descriptor read from
+    RingEnd* ring; // ring read from instead of fd. NULL to read from fd
+    char* buffer; // characters read but not yet handed out
+    int size; // size of buffer. Doubled when a line does not fit
+    int start; // index of the first character not yet handed out
+    int end; // index after the last character read
+} Reader;
 
-    Market* next; // a pointer to the market to the right of this market
-    Market* prev; // a pointer to the market on the left of this market
+/* A DeckStream reads a text deck a chunk at a time while the game is played
+ * so only the next card to draw is held */
+struct DeckStream {
+    Reader reader; // reads the deck file
+    Card next; // next card to draw
+    bool read; // next has been read and not drawn yet
+    bool ended; // every card in the deck has been drawn
 };
 
-/* A Board stores locations of the oldest (left most) market and youngest
- * (right most) markets on the board. The oldest can also be the youngest 
- * if there is only 1 market set up */
+/* A LineReader collects the lines a player sends to the hub without ever
+ * blocking. Data is read only when the event loop says it is waiting */
 typedef struct {
-    Market* oldest; // Right most market set up
-    Market* youngest; // Left most market set up
-} Board;
+    GameState* state; // game the player is in
+    int player; // index of the player being read from
+    int fd; // file descriptor the player writes to
+    RingEnd* ring; // ring the player writes to when using shm. Else NULL
+    int start; // index of the first character not yet handed out
+    int end; // index after the last character read
+    bool discard; // the line being read is too long and is being thrown away
+    bool closed; // EOF has been read or the player is no longer watched
+    bool binary; // records are handed out instead of lines
+    char buffer[READ_BUFFER]; // characters read but not yet handed out
+} LineReader;
+
+/* An EventLoop waits on every player pipe and the signal wake up pipe at 
+ * once. Players using shm are waited on with the hubs bell instead */
+typedef struct {
+    int epollFd; // epoll instance all file descriptors are registered with
+    int sockets; // number of players watched with epoll
+    Bell* bell; // bell of the shm players. NULL if there are none
+    int spin; // microseconds to busy poll the rings before sleeping
+    LineReader* rings[MAX_PLAYERS]; // readers of the shm players
+    int ringCount; // number of readers in rings
+} EventLoop;
 
 /* The Player contains all player related information */
 typedef struct {
@@ -83,30 +222,127 @@ typedef struct {
     long wildPile[MAX_PLAYERS]; // list of all wild tokens player have
     // All discounts that each player has
     int discountList[MAX_PLAYERS][MAX_TOKEN_COLOUR];
+    // bit for each market on the board that each player can afford
+    unsigned long long affordable[MAX_PLAYERS];
     pid_t pidList[MAX_PLAYERS]; // each players ID
     // list of each players communication streams
     FILE* commsList[MAX_PLAYERS][READ_WRITE];
+    LineReader readers[MAX_PLAYERS]; // reads from each players READ stream
+    Outbox outboxes[MAX_PLAYERS]; // messages waiting for each player
+    SharedLink* link; // shared memory of shm players. NULL if there are none
+    int linkFd; // memfd of the shared memory passed to shm players
+    RingEnd rings[MAX_PLAYERS][READ_WRITE]; // each shm players ring ends
+    // strategy of each player loaded from a plugin. NULL for processes
+    DoWhat strategies[MAX_PLAYERS];
+    void* plugins[MAX_PLAYERS]; // handle of each players plugin
+    bool binary[MAX_PLAYERS]; // players that agreed to the binary protocol
 } Player;
 
+/* What happens to a player who runs out of time to reply to dowhat */
+enum TimeoutPolicy {
+    TIMEOUT_ERROR, // the game ends with a protocol error
+    TIMEOUT_FORFEIT, // the player loses their turn
+    TIMEOUT_WILD, // the player takes a wild token
+};
+
+/* A Transport is a way of connecting the hub to player programs */
+typedef struct {
+    const char* name; // name used to choose the transport with -m
+    // starts the player program at path connected to the hub. Sets the
+    // players pid and comms. Returns 0 if the player could not be started
+    int (*start)(GameState* state, int player, char* path);
+} Transport;
+
+/* Hub settings that are set by command line options */
+typedef struct {
+    int games; // number of games to play with the same player processes
+    int graceTime; // milliseconds players have to exit after eog
+    int moveTime; // milliseconds allowed per reply. 0 for no limit
+    int totalTime; // milliseconds allowed per player per game. 0 for no limit
+    int timeoutPolicy; // see TimeoutPolicy enum
+    bool stats; // print statistics about the hub when the game is over
+    bool coalesce; // only flush output to players before dowhat and eog
+    const Transport* transport; // see Transport struct
+    int spin; // microseconds to busy poll shm rings before sleeping
+    bool streamDeck; // read the deck while playing instead of loading it
+    int markets; // most markets that can be set up on the board
+    bool headless; // built in strategies play in the hub without any output
+    int tables; // number of tables the hub plays at once
+    bool binary; // offer the binary protocol to players once they are ready
+} HubConfig;
+
+/* A Clock keeps track of how long each player takes to reply to dowhat */
+typedef struct {
+    long long turnStart; // time the last dowhat was sent in microseconds
+    long long spent[MAX_PLAYERS]; // microseconds used by each player this game
+    long long total[MAX_PLAYERS]; // microseconds used over all games
+    long long longest[MAX_PLAYERS]; // longest reply of each player
+    int replies[MAX_PLAYERS]; // number of replies timed for each player
+    int timeouts[MAX_PLAYERS]; // number of times each player ran out of time
+    int late[MAX_PLAYERS]; // replies still to arrive after running out of time
+    long long spawn[MAX_PLAYERS]; // microseconds taken to start each player
+    // time each player was started until it is ready. Then microseconds
+    // taken from being started to sending the ready message
+    long long ready[MAX_PLAYERS];
+} Clock;
+
+/* Traffic counts what the hub has sent to the player processes */
+typedef struct {
+    long long broadcasts; // messages sent to every player
+    long long copies; // copies of broadcasts written to player pipes
+    long long messages; // messages sent including each copy of a broadcast
+    long long formats; // times a message was formatted
+    long long bytes; // bytes written to player pipes
+    long long writes; // write() calls made to player pipes
+    long long turns; // turns played
+} Traffic;
+
+/* Progress of the hub through starting players and playing a game */
+typedef struct {
+    int ready; // bit for each player that is ready and agreed a protocol
+    int offered; // bit for each player that was offered the binary protocol
+    long long readyBy; // time every player has to be ready by
+    int invalidMessages; // invalid replies received from the current player
+    bool waiting; // dowhat was sent and a reply is expected
+    bool over; // the game has finished
+    bool playing; // a game has been started at the table and not finished
+    bool ended; // the table has ended and everything of it has been freed
+    int status; // exit status the table ended with
+    long long killAt; // players of an ended table still running are killed
+                      // at this time. 0 once none are left
+    bool statusDue; // exit statuses are printed once the players are gone
+} Progress;
+
 /* The GameState contains all information needed to keep track of the game */
-typedef struct {    
+struct GameState {    
     TokenPile tokenPile; // See TokenPile struct
     Deck deck; // See Deck struct
     Board board; // see Board struct
     Player player; // see Player struct
+    HubConfig config; // see HubConfig struct. Only used by the hub
+    EventLoop* loop; // loop waiting on the players. Only used by the hub
+    LineHandler lineHandler; // handles lines from players. Only used by hub
+    Progress progress; // see Progress struct. Only used by the hub
+    Clock clock; // see Clock struct. Only used by the hub
+    Traffic traffic; // see Traffic struct. Only used by the hub
     int victoryPoints; // points needed to end the game 
     int currentPlayer; // index of the player who's turn it is
-} GameState;
+    int game; // number of the game being played. Starts at 1
+    int table; // number of the table the game is at. 0 if there is only one
+    // jumped to once the table has ended. NULL ends the hub instead
+    jmp_buf* tableEnd;
+};
 
 /* A SigStore contains all signal handling information */
 typedef struct {
     int index; // Num of dead children. Used to index into status and children
-    pid_t children[MAX_PLAYERS]; // list of dead children IDs
-    int status[MAX_PLAYERS]; // list of dead children statuses
+    pid_t children[MAX_CHILDREN]; // list of dead children IDs
+    int status[MAX_CHILDREN]; // list of dead children statuses
     bool childSignaled; // Flag to indicate a child was signaled
     bool sigIntCaught; // Flag to indicate a SIGINT was caught
     bool sigPipeCaught; // Flag to indicate a SIGPIPE was caught
-    bool badStart; // Flag to indicate a child died from a bad start
+    int wakePipe[READ_WRITE]; // written to on every signal to wake up waits
+    Bell* wakeBell; // rung on every signal if there are shm players
 } SigStore;
 
 //////////////////////// Private Functions Prototypes /////////////////////////
@@ -154,4 +390,12 @@ char player_int_to_char(int player);
  */
 int player_char_to_int(char player);
 
+/*
+ * gets the current time of a clock that only moves forward. Useful for
+ * timing how long something takes or setting deadlines.
+ *
+ * return: returns the current time in microseconds
+ */
+long long time_now_us(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,356 @@
+/* loop.c
+ *
+ * Author: Michael Bossner
+ *
+ * loop.c contains the hubs event loop and the line readers for each player
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/epoll.h>
+
+#include "loop.h"
+#include "lib.h"
+#include "game.h"
+#include "ring.h"
+#include "wire.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define MAX_EVENTS (MAX_PLAYERS + 1)
+#define EPOLL_FAIL -1
+#define WAKE_BUFFER 64
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Reads whatever a player has sent and hands every complete line to the
+ * lineHandler. If the player has closed its pipe any unfinished line is
+ * handed out followed by NULL and the player is no longer watched.
+ *
+ * loop: event loop the player is watched in
+ *
+ * reader: line reader of the player that is ready
+ */
+static void read_player(EventLoop* loop, LineReader* reader);
+
+/*
+ * Reads from the pipe or ring of a player like read() on a non blocking 
+ * file descriptor
+ *
+ * reader: line reader of the player
+ *
+ * data: storage for what is read
+ *
+ * length: most bytes to read
+ *
+ * return: returns the bytes read, 0 at EOF or -1 with errno set
+ */
+static int read_input(LineReader* reader, char* data, int length);
+
+/*
+ * Sets up a line reader for a player
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to read from
+ *
+ * fd: file descriptor the player writes to. INVALID if it uses a ring
+ *
+ * end: ring the player writes to. NULL if it uses a file descriptor
+ *
+ * return: returns the reader of the player
+ */
+static LineReader* init_reader(GameState* state, int player, int fd, 
+        RingEnd* end);
+
+/*
+ * Waits on epoll for the pipes of players and the signal wake up pipe
+ *
+ * loop: event loop to wait on
+ *
+ * timeout: Maximum milliseconds to wait. NO_TIMEOUT waits forever
+ *
+ * return: returns the number of file descriptors that were ready
+ */
+static int wait_events(EventLoop* loop, int timeout);
+
+/*
+ * Waits on the hubs bell for the rings of shm players. Busy polls the rings
+ * first for loop->spin microseconds. The pipes of other players and the
+ * wake up pipe are checked without waiting.
+ *
+ * loop: event loop to wait on
+ *
+ * timeout: Maximum milliseconds to wait. NO_TIMEOUT waits forever
+ *
+ * return: returns the number of pipes and rings that were read
+ */
+static int run_shared(EventLoop* loop, int timeout);
+
+/*
+ * Checks if any ring watched by the loop has data or has been closed
+ *
+ * loop: event loop with the rings
+ *
+ * return: returns true if a ring needs reading else false
+ */
+static bool rings_ready(EventLoop* loop);
+
+/*
+ * Checks if the ring of a reader has data or has ended and not yet been
+ * read to its end
+ *
+ * reader: line reader of a shm player
+ *
+ * return: returns true if the ring needs reading else false
+ */
+static bool is_ring_ready(LineReader* reader);
+
+/*
+ * Hands every complete line in the readers buffer to the lineHandler.
+ * A line that was too long for the buffer is handed out as an empty line.
+ * Once the reader is binary complete records are handed out instead. The
+ * lineHandler may make the reader binary part way through the buffer.
+ *
+ * reader: line reader holding the lines
+ */
+static void hand_out_lines(LineReader* reader);
+
+/*
+ * Empties the signal wake up pipe
+ */
+static void drain_wake_pipe(void);
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int init_loop(EventLoop* loop) {
+    struct epoll_event event;
+
+    loop->sockets = 0;
+    loop->bell = NULL;
+    loop->spin = 0;
+    loop->ringCount = 0;
+    if ((loop->epollFd = epoll_create1(EPOLL_CLOEXEC)) == EPOLL_FAIL) {
+        return FAIL;
+    }
+    event.events = EPOLLIN;
+    event.data.ptr = NULL; // NULL marks the wake up pipe
+    if (epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, sigStore.wakePipe[READ], 
+            &event) == EPOLL_FAIL) {
+        return FAIL;
+    }
+    return VALID;
+}
+
+int watch_player(EventLoop* loop, GameState* state, int player, int fd) {
+    LineReader* reader = init_reader(state, player, fd, NULL);
+    struct epoll_event event;
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    event.events = EPOLLIN;
+    event.data.ptr = reader;
+    if (epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, fd, &event) == EPOLL_FAIL) {
+        return FAIL;
+    }
+    loop->sockets++;
+    return VALID;
+}
+
+void watch_ring(EventLoop* loop, GameState* state, int player, RingEnd* end,
+        Bell* bell, int spin) {
+    loop->rings[loop->ringCount++] = init_reader(state, player, INVALID, end);
+    loop->bell = bell;
+    loop->spin = spin;
+}
+
+void unwatch_players(EventLoop* loop, GameState* state) {
+    for (int player = 0; player < state->player.count; player++) {
+        LineReader* reader = &state->player.readers[player];
+        if (reader->state != state || reader->closed) {
+            continue; // never watched or already out of the loop
+        }
+        reader->closed = true; // events already waited for are skipped
+        if (reader->ring == NULL) {
+            epoll_ctl(loop->epollFd, EPOLL_CTL_DEL, reader->fd, NULL);
+        }
+    }
+}
+
+int run_loop(EventLoop* loop, int timeout) {
+    if (loop->bell != NULL) {
+        return run_shared(loop, timeout);
+    }
+    return wait_events(loop, timeout);
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void read_player(EventLoop* loop, LineReader* reader) {
+    if (reader->closed) {
+        return;
+    }
+    int got = read_input(reader, &reader->buffer[reader->end], 
+            READ_BUFFER - 1 - reader->end); // keep room for the '\0'
+
+    if (got < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return; // nothing to read after all
+    } else if (got <= 0) { // EOF or the pipe is broken
+        reader->closed = true;
+        if (reader->ring == NULL) {
+            epoll_ctl(loop->epollFd, EPOLL_CTL_DEL, reader->fd, NULL);
+        }
+        if (reader->end > reader->start && !reader->discard && 
+                !reader->binary) { // there is a message but EOF was found
+            reader->buffer[reader->end] = '\0';
+            reader->state->lineHandler(reader->state, reader->player,
+                    &reader->buffer[reader->start]);
+        }
+        reader->state->lineHandler(reader->state, reader->player, NULL);
+        return;
+    }
+    reader->end += got;
+    hand_out_lines(reader);
+
+    if (reader->start == reader->end) { // everything was handed out
+        reader->start = 0;
+        reader->end = 0;
+    } else if (reader->end == READ_BUFFER - 1) { // buffer is full
+        if (reader->start > 0) { // move the unfinished line to the front
+            memmove(reader->buffer, &reader->buffer[reader->start], 
+                    reader->end - reader->start);
+            reader->end -= reader->start;
+            reader->start = 0;
+        } else { // line is too long to be a message
+            reader->discard = true;
+            reader->end = 0;
+        }
+    }
+}
+
+//
+static int read_input(LineReader* reader, char* data, int length) {
+    if (reader->ring != NULL) {
+        return ring_read(reader->ring, data, length);
+    }
+    return read(reader->fd, data, length);
+}
+
+//
+static LineReader* init_reader(GameState* state, int player, int fd, 
+        RingEnd* end) {
+    LineReader* reader = &state->player.readers[player];
+
+    reader->state = state;
+    reader->player = player;
+    reader->fd = fd;
+    reader->ring = end;
+    reader->start = 0;
+    reader->end = 0;
+    reader->discard = false;
+    reader->closed = false;
+    reader->binary = false;
+    return reader;
+}
+
+//
+static int wait_events(EventLoop* loop, int timeout) {
+    struct epoll_event events[MAX_EVENTS];
+    int ready = epoll_wait(loop->epollFd, events, MAX_EVENTS, timeout);
+
+    if (ready == EPOLL_FAIL) { // interrupted by a signal
+        return 0;
+    }
+    for (int i = 0; i < ready; i++) {
+        if (events[i].data.ptr == NULL) {
+            drain_wake_pipe();
+        } else {
+            read_player(loop, events[i].data.ptr);
+        }
+    }
+    return ready;
+}
+
+//
+static int run_shared(EventLoop* loop, int timeout) {
+    unsigned int seen = seen_bell(loop->bell);
+    int ready = wait_events(loop, 0);
+
+    if (ready == 0 && !rings_ready(loop)) {
+        long long spinEnd = time_now_us() + loop->spin;
+        while (time_now_us() < spinEnd && !rings_ready(loop)) {
+        }
+        if (!rings_ready(loop)) {
+            if (loop->sockets > 0 && 
+                    (timeout == NO_TIMEOUT || timeout > SOCKET_SLICE)) {
+                timeout = SOCKET_SLICE; // others can not ring the bell
+            }
+            wait_bell(loop->bell, seen, 
+                    timeout == NO_TIMEOUT ? -1 : timeout * US_PER_MS);
+        }
+        ready = wait_events(loop, 0);
+    }
+    for (int i = 0; i < loop->ringCount; i++) {
+        if (is_ring_ready(loop->rings[i])) {
+            read_player(loop, loop->rings[i]);
+            ready++;
+        }
+    }
+    return ready;
+}
+
+//
+static bool rings_ready(EventLoop* loop) {
+    for (int i = 0; i < loop->ringCount; i++) {
+        if (is_ring_ready(loop->rings[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//
+static bool is_ring_ready(LineReader* reader) {
+    return !reader->closed && (ring_has_data(reader->ring) || 
+            ring_has_ended(reader->ring));
+}
+
+//
+static void hand_out_lines(LineReader* reader) {
+    char* newLine;
+
+    FOREVER {
+        char* line = &reader->buffer[reader->start];
+        if (reader->binary) {
+            if (reader->end == reader->start || reader->end - 
+                    reader->start < record_size(*line)) {
+                return;
+            }
+            reader->start += record_size(*line);
+            reader->state->lineHandler(reader->state, reader->player, line);
+            continue;
+        }
+        if ((newLine = memchr(line, '\n', 
+                reader->end - reader->start)) == NULL) {
+            return;
+        }
+        *newLine = '\0';
+        reader->start = (newLine - reader->buffer) + 1;
+        if (reader->discard) { // only the end of a long line
+            reader->discard = false;
+            line = newLine;
+        }
+        reader->state->lineHandler(reader->state, reader->player, line);
+    }
+}
+
+//
+static void drain_wake_pipe(void) {
+    char buffer[WAKE_BUFFER];
+    while (read(sigStore.wakePipe[READ], buffer, WAKE_BUFFER) > 0) {
+    }
+}
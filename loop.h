@@ -0,0 +1,94 @@
+/* loop.h
+ *
+ * Author: Michael Bossner
+ *
+ * loop.h header file for loop.c
+ */
+
+#ifndef LOOP_H
+#define LOOP_H
+
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define NO_TIMEOUT -1
+#define SOCKET_SLICE 1
+
+///////////////////////// Public Function Prototypes //////////////////////////
+
+/*
+ * Sets up the event loop and registers the read end of the signal wake up 
+ * pipe so signals will wake the loop
+ *
+ * loop: event loop to be set up
+ *
+ * return: returns 0 if the loop could not be created else returns 1
+ */
+int init_loop(EventLoop* loop);
+
+/*
+ * Starts watching the read stream of a player. Every line the player sends
+ * will be passed to the states lineHandler. The file descriptor is made non
+ * blocking so it must not be read through a FILE* afterwards.
+ *
+ * loop: event loop to watch the player in
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to watch
+ *
+ * fd: file descriptor the player writes to
+ *
+ * return: returns 0 if the player could not be watched else returns 1
+ */
+int watch_player(EventLoop* loop, GameState* state, int player, int fd);
+
+/*
+ * Starts watching the ring a player using the shm transport writes to. 
+ * Once a player is watched this way the loop sleeps on the hubs bell 
+ * instead of in epoll. Any players still watched with epoll are then only
+ * checked every SOCKET_SLICE milliseconds.
+ *
+ * loop: event loop to watch the player in
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to watch
+ *
+ * end: hubs reading end of the ring
+ *
+ * bell: bell rung when the ring has data
+ *
+ * spin: microseconds to busy poll the rings before sleeping on the bell
+ */
+void watch_ring(EventLoop* loop, GameState* state, int player, RingEnd* end,
+        Bell* bell, int spin);
+
+/*
+ * Stops watching every player of a table so nothing more is read from them
+ * or handed to the table. Must be called before the players file
+ * descriptors are closed as the loop may be shared with other tables that
+ * get the same numbers back. Players that were never watched are skipped.
+ *
+ * loop: event loop the players are watched in
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+void unwatch_players(EventLoop* loop, GameState* state);
+
+/*
+ * Waits until any watched player has sent something, closed its pipe or a
+ * signal is caught. All complete lines that have arrived are passed to the
+ * lineHandler of the game they belong to before returning.
+ *
+ * loop: event loop to wait on
+ *
+ * timeout: Maximum milliseconds to wait. NO_TIMEOUT waits forever
+ *
+ * return: returns the number of file descriptors that were ready. 0 if the
+ *         timeout ran out or the wait was interrupted
+ */
+int run_loop(EventLoop* loop, int timeout);
+
+#endif
@@ -0,0 +1,93 @@
+/* moves.c
+ *
+ * Author: Michael Bossner
+ *
+ * moves.c lists the legal moves of a player. Nothing is allocated so it
+ * can be called for every position of a search.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include "moves.h"
+#include "lib.h"
+#include "board.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define WILD_TOKENS MAX_TOKEN_COLOUR
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Lists the legal takes. A take leaves out one colour and the other 3
+ * piles must not be empty.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * moves: storage for the takes
+ *
+ * return: returns the number of takes listed
+ */
+static int legal_takes(GameState* state, Action* moves);
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int legal_moves(GameState* state, int player, Action* moves) {
+    int count = legal_takes(state, moves);
+    unsigned long long affordable = state->player.affordable[player];
+
+    while (affordable != 0) { // oldest affordable market first
+        int boardIndex = __builtin_ctzll(affordable);
+        affordable &= affordable - 1;
+        moves[count].type = ACTION_PURCHASE;
+        moves[count].boardIndex = boardIndex;
+        pay_for_market(state, player, boardIndex, moves[count].tokens);
+        count++;
+    }
+    moves[count].type = ACTION_WILD;
+    return count + 1;
+}
+
+void pay_for_market(GameState* state, int player, int boardIndex, 
+        long* tokens) {
+    Card* card = check_market_card(state, boardIndex);
+
+    tokens[WILD_TOKENS] = 0;
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        long held = state->player.tokens[player][colour];
+        long cost = card->cost[colour] - 
+                state->player.discountList[player][colour];
+
+        if (cost > held) { // need wild
+            tokens[colour] = held;
+            // saturates so a huge cost can never wrap round to look cheap
+            tokens[WILD_TOKENS] = (cost - held > LONG_MAX - 
+                    tokens[WILD_TOKENS]) ? LONG_MAX : 
+                    tokens[WILD_TOKENS] + cost - held;
+        } else { // more discounts than cost of the colour pays nothing
+            tokens[colour] = (cost < 0) ? 0 : cost;
+        }
+    }
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int legal_takes(GameState* state, Action* moves) {
+    int count = 0;
+
+    for (int left = RED; left >= PURPLE; left--) {
+        bool legal = true;
+
+        moves[count].type = ACTION_TAKE;
+        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+            moves[count].tokens[colour] = (colour != left);
+            if (colour != left && state->tokenPile.pile[colour] <= 0) {
+                legal = false; // pile is empty
+            }
+        }
+        count += legal;
+    }
+    return count;
+}
@@ -0,0 +1,63 @@
+/* moves.h
+ *
+ * Author: Michael Bossner
+ *
+ * moves.h header file for moves.c
+ */
+
+#ifndef MOVES_H
+#define MOVES_H
+
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+/* Ways to take 3 tokens from the 4 piles */
+#define TAKE_CHOICES 4
+
+/* Most legal moves there can be in one position. Every take, a purchase of
+ * every market and wild */
+#define MAX_MOVES (TAKE_CHOICES + MAX_MARKETS + 1)
+
+///////////////////////// Public Functions Prototypes /////////////////////////
+
+/*
+ * Lists the legal moves a player has. The takes come first, from the
+ * piles nearest purple, then a purchase of each market the player can
+ * afford, oldest first, and wild last. Every move listed is accepted by 
+ * apply_action(). "make check" checks the moves listed against
+ * check_action() in games of random moves.
+ *
+ * Only one payment is listed for each market, the tokens worked out by
+ * pay_for_market(). The rules accept any payment of tokens the player holds
+ * so a purchase paid any other way is legal but not listed.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player to move
+ *
+ * moves: storage for the moves. Must hold MAX_MOVES actions
+ *
+ * return: returns the number of moves listed. Always at least 1 as wild is
+ *         always legal
+ */
+int legal_moves(GameState* state, int player, Action* moves);
+
+/*
+ * Works out the tokens a player pays to buy a market they can afford.
+ * Discounts are used first, then tokens of the colour and wild tokens for
+ * the rest. The wild tokens stop at LONG_MAX for a market whose costs add
+ * up to more.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player buying
+ *
+ * boardIndex: index of the market
+ *
+ * tokens: storage for the tokens of each colour followed by the wild tokens
+ */
+void pay_for_market(GameState* state, int player, int boardIndex, 
+        long* tokens);
+
+#endif
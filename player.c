@@ -10,13 +10,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include "player.h"
 #include "lib.h"
 #include "comms.h"
 #include "board.h"
+#include "afford.h"
+#include "costs.h"
+#include "rules.h"
+#include "moves.h"
 #include "card.h"
-#include "token.h"
+#include "ring.h"
+#include "wire.h"
 
 /////////////////////////////////// Defines ///////////////////////////////////
 
@@ -27,6 +36,7 @@
 #define WILD_START 4
 #define PURCH_START 9
 #define TOOK_START 4
+#define MARKETS_START 7
 #define A_CHAR 65
 #define MAX_PLAYERS 26
 #define MIN_PLAYERS 2
@@ -34,14 +44,18 @@
 #define FLAGGED 1
 #define MIN_TOKENS 3
 #define EOG 3
+#define NEW_GAME_MES 7
 #define DO_WHAT_MES 6
 #define PURCHASED_MIN 22
 #define NEW_CARD_MIN 18
 #define TOKENS_MIN 7
 #define WILD_MIN 5
 #define TOOK_MIN 13
-#define TOKENS_AND_WILD 5
+#define MARKETS_MIN 8
 #define WILD_INDEX 4
+#define STDIN 0
+#define STDOUT 1
+#define FAILED -1
 
 /**/
 enum End {
@@ -62,6 +76,8 @@ enum ActionList {
     TOOK,
     TOKENS,
     WILD,
+    NEW_GAME,
+    MARKETS,
 };
 
 //////////////////////// Private Functions Prototypes /////////////////////////
@@ -74,6 +90,22 @@ enum ActionList {
  */
 static void end_of_game(GameState* state);
 
+/*
+ * prints the game over message for players and prints the winners.
+ * then resets the game state ready for the next game of a tournament
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+static void new_game(GameState* state);
+
+/*
+ * sets all players scores, tokens and discounts back to 0 and clears the
+ * board
+ *
+ * state: Contains all information needed to keep track of the game
+ */
+static void reset_player_state(GameState* state);
+
 /*
  * handles shutting down the player and printed any error messages
  *
@@ -98,6 +130,13 @@ static void end_player(GameState* state, int exitStatus);
  */
 static bool is_eog(char* message);
 
+/*
+ * parses the message to check if it is the newgame message
+ *
+ * return: returns true is the message is "newgame\n" else false
+ */
+static bool is_newgame(char* message);
+
 /*
  * parses the message to check if it is the dowhat message
  *
@@ -145,6 +184,14 @@ static bool is_tokens(char* message);
  */
 static bool is_wild(char* message);
 
+/*
+ * parses the message to check if it is the markets message
+ *
+ * return: returns true if the first 7 character are "markets" else false
+ *         note does not check line length   
+ */
+static bool is_markets(char* message);
+
 /*
  * performs the purchased action by parsing the second half of the message
  * and making sure it is of the correct format if it is the game state is
@@ -239,6 +286,96 @@ static void tokens(GameState* state, char* message);
  */
 static void wild(GameState* state, char* message);
 
+/*
+ * performs the markets action by parsing the message received and making
+ * sure it is of the correct format and updating the board size if it is.
+ * Only sent when the hub does not use DEFAULT_MARKETS.
+ * message format should be
+ *
+ * "M\n"
+ * M: most markets that can be set up on the board
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * message: markets message to be parsed
+ *
+ * Error 6: Communication Error. Invalid message
+ */
+static void markets(GameState* state, char* message);
+
+/*
+ * sets every non-wild pile to the number of tokens given by the tokens
+ * message
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * maxTokens: number of tokens in each non-wild pile
+ *
+ * Error 6: Communication Error. The number is not positive
+ */
+static void set_tokens(GameState* state, long maxTokens);
+
+/*
+ * sets the most markets that can be set up on the board as given by the
+ * markets message
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * size: most markets that can be set up
+ *
+ * Error 6: Communication Error. The size is not from 1 to MAX_MARKETS
+ */
+static void set_markets(GameState* state, long size);
+
+/*
+ * takes an action another player took as told by the hub and prints the
+ * new state
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player who took the action
+ *
+ * action: action taken
+ *
+ * Error 6: Communication Error. The player or market does not exist or the
+ *          action uses negative tokens. An action the rules do not allow
+ *          is only logged and taken anyway as the hub allowed it
+ */
+static void play_action(GameState* state, int player, Action* action);
+
+/*
+ * chooses the action to reply to dowhat with and sends it to the hub
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * doWhat: the strategy that chooses the action
+ */
+static void reply_do_what(GameState* state, DoWhat doWhat);
+
+/*
+ * Answers the offer of a binary protocol sent by the hub. An offer of 
+ * WIRE_OFFER is agreed to and every message after it is a record. Any 
+ * other version is declined and text is kept.
+ *
+ * message: offer received from the hub
+ */
+static void answer_offer(char* message);
+
+/*
+ * performs the message of a record received from the hub once the binary
+ * protocol was agreed. Every field is read from a fixed place so nothing is
+ * parsed.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * message: record received from the hub
+ *
+ * doWhat: the strategy that chooses the action to send in reply to dowhat
+ *
+ * Error 6: Communication Error. Invalid record
+ */
+static void play_record(GameState* state, char* message, DoWhat doWhat);
+
 /*
  * prints the state of the board and the state of all players
  *
@@ -282,24 +419,78 @@ static bool player_parse(GameState* state, char* message);
  *         Returns 5 if the message starts with "took"...
  *         Returns 6 if the message starts with "tokens"...
  *         Returns 7 if the message starts with "wild"...
+ *         Returns 8 if the message is "newgame"
+ *         Returns 9 if the message starts with "markets"...
  */
 static int parse_message(char* message);
 
 /*
- * counts the total number of tokens a card costs
+ * Reads the seat message a hub sends to a daemon player, sets up the game
+ * state from it and plays the game
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * doWhat: the strategy that chooses the action to send in reply to dowhat
+ *
+ * Error 6: Communication Error. The seat message was invalid
+ */
+static void join_game(GameState* state, DoWhat doWhat);
+
+/*
+ * Reads the next message from the hub. The reader is opened on the first
+ * call and reads from the shared memory ring when using shm or stdin. Once
+ * the binary protocol is agreed the message is the next record.
  *
  * state: Contains all information needed to keep track of the game
  *
- * return: returns the number of tokens the card costs
+ * streamEnd: Signals that EOF was received but there is a message waiting
+ *
+ * return: returns the message borrowed from the reader or NULL at EOF
+ *
+ * Error 6: Communication Error. The reader could not be allocated
  */
-static int card_cost_count(GameState* state, Card* card);
+static char* next_message(GameState* state, int* streamEnd);
 
 /*
- * Frees all cards that are being sold by markets on the board
+ * Switches input and stdout to the shared memory rings if the hub started
+ * the player with the shm transport. The rings are found in the memory 
+ * passed as SHM_FD and the AUSTERITY_SHM environment variable holds how
+ * long to busy poll. Does nothing for other transports.
  *
  * state: Contains all information needed to keep track of the game
+ *
+ * Error 6: Communication Error. The shared memory could not be mapped
  */
-static void free_player_card(GameState* state);
+static void open_shared_streams(GameState* state);
+
+/*
+ * Closes the ring to the hub so the hub sees the player end. Registered
+ * with atexit() when using shm.
+ */
+static void close_shared_streams(void);
+
+/*
+ * Checks if the hub has exited. Used as the PeerGone of the players ring
+ * ends.
+ *
+ * peer: pointer to the pid of the hub
+ *
+ * return: returns true if the player no longer belongs to the hub
+ */
+static bool is_hub_gone(void* peer);
+
+/* The players ring ends when using shm. READ comes from the hub and WRITE
+ * goes to the hub */
+static RingEnd sharedEnds[READ_WRITE];
+
+/* Process ID of the hub */
+static pid_t hubPid;
+
+/* Reads the messages from the hub */
+static Reader input;
+
+/* The binary protocol was agreed with the hub */
+static bool binary;
 
 ////////////////////////////////// Functions //////////////////////////////////
 
@@ -323,29 +514,28 @@ void is_args_valid(GameState* state, int argc, char** argv) {
 void init_player(GameState* state, int argc, char** argv) {
     THIS_PLAYER = is_str_pos_number(argv[ARGV_THIS_PLAYER]);
     state->player.count = is_str_pos_number(argv[ARGV_TOTAL_PLAYER]);
+    state->board.size = DEFAULT_MARKETS; // until the hub says otherwise
     
-    for (int player = 0; player < state->player.count; player++) {
-        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
-            state->player.tokens[player][colour] = 0;
-            state->player.discountList[player][colour] = 0;
-        }
-        state->player.scoreCard[player] = 0;
-        state->player.wildPile[player] = 0;
-        state->deck.size = INT_MAX;
-        state->deck.deckIndex = 0;
-    }
-    init_board(state);
+    reset_player_state(state);
 }
 
-void player_loop(GameState* state, void (*doWhat)(GameState* state)) {
+void player_loop(GameState* state, DoWhat doWhat) {
     char* message;
     int streamEnd = 0;
     int action;
 
+    open_shared_streams(state);
+    fprintf(stdout, "ready\n"); // tell the hub we have started
+    fflush(stdout);
+
     FOREVER {
-        if(!(message = rec_message(stdin, &streamEnd)) || 
+        if(!(message = next_message(state, &streamEnd)) || 
                 streamEnd == FLAGGED) { // EOF received
             end_player(state, COMMS_ERR);
+        } else if (binary) {
+            play_record(state, message, doWhat);
+        } else if (strncmp(message, WIRE_PREFIX, strlen(WIRE_PREFIX)) == 0) {
+            answer_offer(message);
         } else {
             action = parse_message(message);
 
@@ -353,13 +543,10 @@ void player_loop(GameState* state, void (*doWhat)(GameState* state)) {
                 case NO_ACTION:
                     end_player(state, COMMS_ERR);
                 case END_OF_GAME:
-                    free(message);
                     end_of_game(state);
                     break;
                 case DO_WHAT:
-                    fprintf(stderr, "Received dowhat\n");
-                    fflush(stderr);
-                    doWhat(state);
+                    reply_do_what(state, doWhat);
                     break;
                 case PURCHASED:
                     purchased(state, &message[PURCH_START]);
@@ -376,54 +563,74 @@ void player_loop(GameState* state, void (*doWhat)(GameState* state)) {
                 case WILD:
                     wild(state, &message[WILD_START]);
                     break;
+                case NEW_GAME:
+                    new_game(state);
+                    break;
+                case MARKETS:
+                    markets(state, &message[MARKETS_START]);
+                    break;
             }
-            free(message);
         }
     }
 }
 
+void serve_player(GameState* state, char* address, DoWhat doWhat) {
+    struct sockaddr_un unixAddress;
+    struct sigaction sigAct;
+    int listener;
+    int hub;
+
+    state->player.count = 0; // nothing to clean up until a game starts
+    init_board(state);
+
+    memset(&sigAct, 0, sizeof(struct sigaction));
+    sigAct.sa_handler = SIG_IGN; // finished games are reaped automatically
+    sigaction(SIGCHLD, &sigAct, NULL);
+
+    if (!unix_address(&unixAddress, address) || (listener = 
+            socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) == FAILED) {
+        end_player(state, COMMS_ERR);
+    }
+    unlink(unixAddress.sun_path); // left behind by an earlier daemon
+    if (bind(listener, (struct sockaddr*)&unixAddress, 
+            sizeof(struct sockaddr_un)) == FAILED || 
+            listen(listener, SOMAXCONN) == FAILED) {
+        end_player(state, COMMS_ERR);
+    }
+
+    FOREVER {
+        if ((hub = accept(listener, NULL, NULL)) == FAILED) {
+            continue;
+        }
+        pid_t game = fork();
+        if (game == 0) { // Child plays the game on the connection
+            close(listener);
+            dup2(hub, STDIN);
+            dup2(hub, STDOUT);
+            close(hub);
+            join_game(state, doWhat);
+        }
+        close(hub);
+    }
+}
+
 int can_buy_card(GameState* state, int* cardIndexs, int pointMin, int player) {
+    unsigned long long affordable = state->player.affordable[player];
     int count = 0;
-    int boardIndex = 0;
-    long totalWild;
-    Market* market = state->board.oldest;
-
-    while (market != NULL) {
-        totalWild = state->player.wildPile[player];
-        for (int i = 0; i < MAX_TOKEN_COLOUR; i++) {
-            if ((state->player.tokens[player][i] + 
-                    state->player.discountList[player][i] +
-                    totalWild) >= 
-                    market->card->cost[i]) { // can purchase
-
-                if ((state->player.tokens[player][i] + 
-                        state->player.discountList[player][i]) < 
-                        market->card->cost[i]) { // must use wild tokens
-                    totalWild -= (market->card->cost[i] - 
-                            (state->player.tokens[player][i] + 
-                            state->player.discountList[player][i]));
-                }               
-            } else {
-                break;
-            }
-            if (i == (MAX_TOKEN_COLOUR - 1)) { // can purchase
-                if (market->card->points < pointMin) { //not above the pointMin
-                    break;
-                } else { // adding to the index
-                    cardIndexs[count] = boardIndex;
-                    count++;
-                }
-            }
+
+    while (affordable != 0) { // oldest affordable market first
+        int boardIndex = __builtin_ctzll(affordable);
+        affordable &= affordable - 1;
+        if (check_market_card(state, boardIndex)->points >= pointMin) {
+            cardIndexs[count] = boardIndex;
+            count++;
         }
-        boardIndex++;
-        market = market->next;
     }
     return count;
 }
 
-void take_wild(void) {
-    fprintf(stdout, "wild\n");
-    fflush(stdout);
+void take_wild(Action* action) {
+    action->type = ACTION_WILD;
 }
 
 bool can_take_tokens(GameState* state) {
@@ -442,54 +649,72 @@ bool can_take_tokens(GameState* state) {
     }
 }
 
-void take(long* tokens) {
-    fprintf(stdout, "take%ld,%ld,%ld,%ld\n",
-            tokens[PURPLE],
-            tokens[BROWN],
-            tokens[YELLOW],
-            tokens[RED]);
-    fflush(stdout);
+void take(Action* action, long* tokens) {
+    action->type = ACTION_TAKE;
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        action->tokens[colour] = tokens[colour];
+    }
 }
 
-void purchase(int cardNum, long* tokens, long wild) {
-    fprintf(stdout, "purchase%d:%ld,%ld,%ld,%ld,%ld\n",
-            cardNum,
-            tokens[PURPLE],
-            tokens[BROWN],
-            tokens[YELLOW],
-            tokens[RED],
-            wild);
+void purchase(Action* action, int cardNum, long* tokens, long wild) {
+    action->type = ACTION_PURCHASE;
+    action->boardIndex = cardNum;
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        action->tokens[colour] = tokens[colour];
+    }
+    action->tokens[WILD_INDEX] = wild;
+}
+
+void send_action(Action* action) {
+    if (binary) {
+        Record record;
+        char packed[MAX_RECORD];
+
+        action_to_record(&record, 0, action); // the hub knows who we are
+        fwrite(packed, 1, encode_record(&record, packed), stdout);
+        fflush(stdout);
+        return;
+    }
+    switch (action->type) {
+        case ACTION_WILD:
+            fprintf(stdout, "wild\n");
+            break;
+        case ACTION_TAKE:
+            fprintf(stdout, "take%ld,%ld,%ld,%ld\n",
+                    action->tokens[PURPLE],
+                    action->tokens[BROWN],
+                    action->tokens[YELLOW],
+                    action->tokens[RED]);
+            break;
+        case ACTION_PURCHASE:
+            fprintf(stdout, "purchase%d:%ld,%ld,%ld,%ld,%ld\n",
+                    action->boardIndex,
+                    action->tokens[PURPLE],
+                    action->tokens[BROWN],
+                    action->tokens[YELLOW],
+                    action->tokens[RED],
+                    action->tokens[WILD_INDEX]);
+            break;
+    }
     fflush(stdout);
 }
 
 void load_tokens(GameState* state, int boardIndex, long* tokens, long* wild) {
     // assumes we can afford the card
-    *wild = 0;
+    long payment[MAX_TOKEN_COLOUR + 1];
+
+    pay_for_market(state, THIS_PLAYER, boardIndex, payment);
     for (int i = 0; i < MAX_TOKEN_COLOUR; i++) {
-        tokens[i] = 0;
-        if ((state->player.tokens[THIS_PLAYER][i] + 
-                state->player.discountList[THIS_PLAYER][i]) < 
-                check_market_card(state, boardIndex)->cost[i]) { // need wild
-
-            tokens[i] = (state->player.tokens[THIS_PLAYER][i]);
-            *wild += ((check_market_card(state, boardIndex)->cost[i]) -
-                    (state->player.tokens[THIS_PLAYER][i] + 
-                    state->player.discountList[THIS_PLAYER][i]));
-        } else { // dont need wild
-            tokens[i] = ((check_market_card(state, boardIndex)->cost[i]) -
-                    state->player.discountList[THIS_PLAYER][i]);
-            if (tokens[i] < 0) { // more discounts than cost of the colour
-                tokens[i] = 0;
-            }
-        }
+        tokens[i] = payment[i];
     }
+    *wild = payment[MAX_TOKEN_COLOUR];
 }
 
 int find_highest_index(GameState* state, int* cardIndexs, int* canPurch) {
     // find highest point card or if there are more then 1
     long highest = 0;
     int tempIndexs[MAX_MARKETS];
-    int tempCanPurch;
+    int tempCanPurch = 0;
 
     for (int i = 0; i < *canPurch; i++) {       
         if (highest < 
@@ -514,13 +739,13 @@ int find_highest_index(GameState* state, int* cardIndexs, int* canPurch) {
 int find_lowest_cost(GameState* state, int* canPurch, int* cardIndexs) {
     int lowestCount = INT_MAX;
     int tempIndexs[MAX_MARKETS];
-    int tempCanPurch;
+    int tempCanPurch = 0;
+    int totals[MAX_MARKETS];
     int count;
-    Card* card;
 
+    total_costs(state, THIS_PLAYER, totals);
     for (int i = 0; i < *canPurch; i++) {
-        card = check_market_card(state, cardIndexs[i]);
-        count = card_cost_count(state, card);
+        count = totals[cardIndexs[i]];
         
         if (count < lowestCount) { // lowest cost
             lowestCount = count;
@@ -541,13 +766,13 @@ int find_lowest_cost(GameState* state, int* canPurch, int* cardIndexs) {
 int find_highest_cost(GameState* state, int* canPurch, int* cardIndexs) {
     int highestCount = 0;
     int tempIndexs[MAX_MARKETS];
-    int tempCanPurch;
+    int tempCanPurch = 0;
+    int totals[MAX_MARKETS];
     int count;
-    Card* card;
 
+    total_costs(state, THIS_PLAYER, totals);
     for (int i = 0; i < *canPurch; i++) { 
-        card = check_market_card(state, cardIndexs[i]);
-        count = card_cost_count(state, card);
+        count = totals[cardIndexs[i]];
 
         if (count > highestCount) { // highest cost
             highestCount = count;
@@ -566,14 +791,15 @@ int find_highest_cost(GameState* state, int* canPurch, int* cardIndexs) {
 }
 
 int highest_wild_cost(GameState* state, int* canPurch, int* cardIndexs) {
-    long tokens[MAX_TOKEN_COLOUR];
+    int need[MAX_MARKETS];
     long wild;
     int tempIndexs[MAX_MARKETS];
-    int tempCanPurch;
+    int tempCanPurch = 0;
     int highestWild = 0;
 
+    wild_needed(state, THIS_PLAYER, need);
     for (int i = 0; i < *canPurch; i++) {
-        load_tokens(state, cardIndexs[i], tokens, &wild);
+        wild = need[cardIndexs[i]];
 
         if (wild > highestWild) { // highest wild cost
             highestWild = wild;
@@ -592,6 +818,77 @@ int highest_wild_cost(GameState* state, int* canPurch, int* cardIndexs) {
 }
 
 ////////////////////////////// Private Functions //////////////////////////////
+//
+static void join_game(GameState* state, DoWhat doWhat) {
+    int streamEnd = 0;
+    int prefix = strlen(SEAT_MESSAGE);
+    char* separator;
+    char* message = next_message(state, &streamEnd);
+
+    if (message == NULL || streamEnd == FLAGGED || 
+            strncmp(message, SEAT_MESSAGE, prefix) != 0 || 
+            (separator = strchr(message, ':')) == NULL) {
+        end_player(state, COMMS_ERR);
+    }
+    *separator = '\0';
+    char* args[ARG_COUNT] = {SEAT_MESSAGE, &message[prefix], &separator[1]};
+
+    is_args_valid(state, ARG_COUNT, args);
+    init_player(state, ARG_COUNT, args);
+    player_loop(state, doWhat);
+}
+
+//
+static char* next_message(GameState* state, int* streamEnd) {
+    if (input.buffer == NULL && !open_reader(&input, STDIN_FILENO, 
+            sharedEnds[READ].ring != NULL ? &sharedEnds[READ] : NULL)) {
+        end_player(state, COMMS_ERR);
+    }
+    if (binary) {
+        return read_record(&input, streamEnd);
+    }
+    return read_line(&input, NULL, streamEnd);
+}
+
+//
+static void open_shared_streams(GameState* state) {
+    char* spin = getenv(SHM_ENV);
+    SharedLink* link;
+
+    if (spin == NULL) {
+        return;
+    } else if ((link = attach_link(SHM_FD)) == NULL) {
+        end_player(state, COMMS_ERR);
+    }
+    hubPid = getppid();
+    for (int direction = READ; direction <= WRITE; direction++) {
+        // the players READ end is the hubs WRITE ring and the other way
+        sharedEnds[direction].ring = 
+                &link->rings[THIS_PLAYER][direction == READ ? WRITE : READ];
+        sharedEnds[direction].spin = atoi(spin);
+        sharedEnds[direction].gone = is_hub_gone;
+        sharedEnds[direction].peer = &hubPid;
+    }
+    sharedEnds[READ].bell = NULL;
+    sharedEnds[WRITE].bell = &link->hubBell;
+
+    if ((stdout = open_ring_stream(&sharedEnds[WRITE], "w")) == NULL) {
+        end_player(state, COMMS_ERR);
+    }
+    atexit(close_shared_streams);
+}
+
+//
+static void close_shared_streams(void) {
+    fflush(stdout);
+    ring_close(&sharedEnds[WRITE]);
+}
+
+//
+static bool is_hub_gone(void* peer) {
+    return getppid() != *(pid_t*)peer;
+}
+
 //
 static void end_player(GameState* state, int exitStatus) {
     char* program[] = {"shenzi", "banzai", "ed"};
@@ -615,7 +912,6 @@ static void end_player(GameState* state, int exitStatus) {
     }
     fflush(stderr);
 
-    free_player_card(state);
     free_board(state);
     exit(exitStatus);
 }
@@ -632,6 +928,10 @@ static int parse_message(char* message) {
         if (is_dowhat(message)) {
             return DO_WHAT;
         }
+    } else if (len == NEW_GAME_MES) {
+        if (is_newgame(message)) {
+            return NEW_GAME;
+        }
     }
     if (len >= PURCHASED_MIN) {
         if (is_purchased(message)) {
@@ -648,6 +948,11 @@ static int parse_message(char* message) {
             return TOOK;
         }
     }
+    if (len >= MARKETS_MIN) {
+        if (is_markets(message)) {
+            return MARKETS;
+        }
+    }
     if (len >= TOKENS_MIN) {
         if (is_tokens(message)) {
             return TOKENS;
@@ -670,6 +975,17 @@ static bool is_eog(char* message) {
     }
 }
 
+//
+static bool is_newgame(char* message) {
+    if (message[0] == 'n' && message[1] == 'e' && message[2] == 'w' &&
+            message[3] == 'g' && message[4] == 'a' && message[5] == 'm' &&
+            message[6] == 'e') {
+        return true;
+    } else {
+        return false;
+    }
+}
+
 //
 static bool is_dowhat(char* message) {
     if (message[0] == 'd' && message[1] == 'o' && message[2] == 'w' &&
@@ -732,6 +1048,15 @@ static bool is_wild(char* message) {
     } 
 }
 
+//
+static bool is_markets(char* message) {
+    if (strncmp(message, "markets", MARKETS_START) == 0) {
+        return true;
+    } else {
+        return false;
+    }
+}
+
 //
 static void end_of_game(GameState* state) {
     char* winners = "Game over. Winners are ";
@@ -740,38 +1065,37 @@ static void end_of_game(GameState* state) {
 }
 
 //
-static void purchased(GameState* state, char* message) {
-    Card* card;
-    int player;
-    int boardIndex;
-    char* mesIndex = &message[2];
-    long tokens[TOKENS_AND_WILD];
+static void new_game(GameState* state) {
+    char* winners = "Game over. Winners are ";
+    print_winners(state, winners, stderr);
 
-    if (!player_parse(state, message)) { // invalid player
-        end_player(state, COMMS_ERR);
-    }
-    player = player_char_to_int(message[0]);
+    free_board(state);
+    reset_player_state(state);
+}
 
-    if (!is_valid_purchase(tokens, mesIndex, &boardIndex)) { // invalid
-        end_player(state, COMMS_ERR);
+//
+static void reset_player_state(GameState* state) {
+    for (int player = 0; player < state->player.count; player++) {
+        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+            state->player.tokens[player][colour] = 0;
+            state->player.discountList[player][colour] = 0;
+        }
+        state->player.scoreCard[player] = 0;
+        state->player.wildPile[player] = 0;
     }
+    init_board(state);
+}
 
-    if ((card = purchase_card(state, boardIndex)) == NULL) { // invalid index
-        end_player(state, COMMS_ERR);
-    } // card now removed from board
-
-    for (int i = 0; i < MAX_TOKEN_COLOUR; i++) { // updates sate
-        state->player.tokens[player][i] -= tokens[i];
-        state->tokenPile.pile[i] += tokens[i];
-    }   
-    state->player.wildPile[player] -= tokens[WILD_INDEX];
-    add_discount(state, card->discount, player);
-    state->player.scoreCard[player] += card->points;    
-    
-    free(card);
+//
+static void purchased(GameState* state, char* message) {
+    Action action = {.type = ACTION_PURCHASE};
+    char* mesIndex = &message[2];
 
-    // send state to all
-    print_state(state, stderr);
+    if (!player_parse(state, message) || 
+            !is_valid_purchase(action.tokens, mesIndex, &action.boardIndex)) {
+        end_player(state, COMMS_ERR);
+    }
+    play_action(state, player_char_to_int(message[0]), &action);
 }
 
 //
@@ -787,14 +1111,11 @@ static bool player_parse(GameState* state, char* message) {
 
 //
 static void new_card(GameState* state, char* message) {
-    Card* card = malloc(sizeof(Card) * 1);
-    if (unwrap_card(message, card)) {
-        if (!add_to_board(state, card)) {
-            free(card);
-        }
+    Card card;
+    if (unwrap_card(message, &card)) {
+        add_to_board(state, &card);
         print_state(state, stderr);
     } else {
-        free(card);
         end_player(state, COMMS_ERR);
     }
 }
@@ -805,50 +1126,133 @@ static void took(GameState* state, char* message) {
         end_player(state, COMMS_ERR);
     }
 
-    int player = player_char_to_int(message[0]);
+    Action action = {.type = ACTION_TAKE};
     char* mesIndex = &message[2];
-    long tokens[MAX_TOKEN_COLOUR];
 
-    if(!is_valid_take(tokens, mesIndex)) {
+    if (!is_valid_take(action.tokens, mesIndex)) {
         end_player(state, COMMS_ERR);
     }
+    play_action(state, player_char_to_int(message[0]), &action);
+}
+
+//
+static void tokens(GameState* state, char* message) {
+    set_tokens(state, is_str_pos_number(message));
+}
 
-    for (int i = 0; i < MAX_TOKEN_COLOUR; i++) { // updates state
-        state->player.tokens[player][i] += tokens[i];
-        state->tokenPile.pile[i] -= tokens[i];
+//
+static void wild(GameState* state, char* message) {
+
+    if ((message[0] < A_CHAR) || 
+            (message[0] > (A_CHAR + state->player.count - 1))) { 
+        // invalid player name
+        end_player(state, COMMS_ERR);
     }
+    play_action(state, player_char_to_int(message[0]), 
+            &(Action){.type = ACTION_WILD});
+}
 
+//
+static void markets(GameState* state, char* message) {
+    set_markets(state, is_str_pos_number(message));
+}
+
+//
+static void set_tokens(GameState* state, long maxTokens) {
+    if (maxTokens < 0) {
+        end_player(state, COMMS_ERR);
+    }
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        // state updates
+        state->tokenPile.pile[colour] = maxTokens;
+    }
+    state->tokenPile.maxTokens = maxTokens;
     print_state(state, stderr);
 }
 
 //
-static void tokens(GameState* state, char* message) {
-    int maxTokens;
+static void set_markets(GameState* state, long size) {
+    if (size < 1 || size > MAX_MARKETS) {
+        end_player(state, COMMS_ERR);
+    }
+    state->board.size = size;
+}
+
+//
+static void play_action(GameState* state, int player, Action* action) {
+    int result = apply_action(state, player, action, NULL);
 
-    if ((maxTokens = is_str_pos_number(message)) == INVALID) {
+    if (result == RULE_BAD_PLAYER || result == RULE_NO_MARKET || 
+            result == RULE_BAD_ACTION) { // the message itself is wrong
         end_player(state, COMMS_ERR);
+    } else if (result != RULE_APPLIED) { // the hub decides what is legal
+        fprintf(stderr, "Player %c took an action the rules do not allow\n",
+                player_int_to_char(player));
+        force_action(state, player, action, NULL);
+    }
+    print_state(state, stderr);
+}
+
+//
+static void reply_do_what(GameState* state, DoWhat doWhat) {
+    Action chosen;
+
+    fprintf(stderr, "Received dowhat\n");
+    fflush(stderr);
+    doWhat(state, &chosen);
+    send_action(&chosen);
+}
+
+//
+static void answer_offer(char* message) {
+    if (strcmp(message, WIRE_OFFER) == 0) {
+        fprintf(stdout, "%s\n", WIRE_OFFER);
+        binary = true;
     } else {
-        for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
-            // state updates
-            state->tokenPile.pile[colour] = maxTokens;
-        }
-        state->tokenPile.maxTokens = maxTokens;
-        print_state(state, stderr);
+        fprintf(stdout, "%s\n", WIRE_DECLINE);
     }
+    fflush(stdout);
 }
 
 //
-static void wild(GameState* state, char* message) {
+static void play_record(GameState* state, char* message, DoWhat doWhat) {
+    Record record;
+    Action action;
+    Card card;
 
-    if ((message[0] < A_CHAR) || 
-            (message[0] > (A_CHAR + state->player.count - 1))) { 
-        // invalid player name
+    if (!decode_record(message, &record)) {
         end_player(state, COMMS_ERR);
     }
-    // updates state
-    int player = player_char_to_int(message[0]);
-    state->player.wildPile[player] += 1;    
-    print_state(state, stderr);
+    switch (record.type) {
+        case WIRE_EOG:
+            end_of_game(state);
+            break;
+        case WIRE_DOWHAT:
+            reply_do_what(state, doWhat);
+            break;
+        case WIRE_PURCHASED:
+        case WIRE_TOOK:
+        case WIRE_WILD:
+            record_to_action(&record, &action);
+            play_action(state, record.player, &action);
+            break;
+        case WIRE_NEWCARD:
+            if (!record_to_card(&record, &card)) {
+                end_player(state, COMMS_ERR);
+            }
+            add_to_board(state, &card);
+            print_state(state, stderr);
+            break;
+        case WIRE_TOKENS:
+            set_tokens(state, record.values[0]);
+            break;
+        case WIRE_NEWGAME:
+            new_game(state);
+            break;
+        case WIRE_MARKETS:
+            set_markets(state, record.values[0]);
+            break;
+    }
 }
 
 //
@@ -876,29 +1280,4 @@ static void print_player_state(GameState* state, FILE* stream) {
                 state->player.wildPile[player]);
         fflush(stream);
     }
-}
-
-//
-static int card_cost_count(GameState* state, Card* card) {
-    int count = 0;  
-    
-    for (int i = 0; i < MAX_TOKEN_COLOUR; i++) {
-        count += card->cost[i];
-        if (card->cost[i] > 0) {
-            count -= state->player.discountList[THIS_PLAYER][i];
-            if (count < 0) {
-                count = 0;
-            }
-        }           
-    }
-    return count;
-}
-
-//
-static void free_player_card(GameState* state) {
-    Market* market = state->board.oldest;
-    while (market != NULL) {
-        free(market->card);
-        market = market->next;
-    }
 }
\ No newline at end of file
@@ -13,6 +13,8 @@
 /////////////////////////////////// Defines ///////////////////////////////////
 
 #define THIS_PLAYER state->currentPlayer
+#define DAEMON_ARG_COUNT 2
+#define ARGV_ADDRESS 1
 
 ///////////////////////// Public Function Prototypes //////////////////////////
 
@@ -49,20 +51,50 @@ void is_args_valid(GameState* state, int argc, char** argv);
 void init_player(GameState* state, int argc, char** argv);
 
 /*
- * The players game loop. Waits for a messages then parses it. if it is a
- * valid message the appropriate action is then taken and the loop repeats
+ * The players game loop. Tells the hub the player is ready then waits for
+ * a messages and parses it. if it is a valid message the appropriate action
+ * is then taken and the loop repeats
  *
  * state: Contains all information needed to keep track of the game
  *
- * doWhat: the function that will respond to the dowhat message
+ * doWhat: the strategy that chooses the action to send in reply to dowhat
  *
  * Error 6: Communication Error. pipe closed before the end of the game or an
  *          Invalid message was received.
  */
-void player_loop(GameState* state, void (*doWhat)(GameState* state));
+void player_loop(GameState* state, DoWhat doWhat);
 
 /*
- * checks if there are any card on the board that the player can purchase
+ * Runs the player as a daemon listening on a unix domain socket. Each hub
+ * that connects gets its own copy of the player which reads the seat 
+ * message
+ *
+ * "seatN:I\n"
+ * N: number of players in the game
+ * I: index of this player
+ *
+ * and then plays the game over the connection with player_loop(). The
+ * daemon keeps listening for hubs until it is killed.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * address: "unix:PATH" address to listen on. Any file left at PATH is
+ *          replaced
+ *
+ * doWhat: the strategy that chooses the action to send in reply to dowhat
+ *
+ * Error 6: Communication Error. The socket could not be listened on or the
+ *          seat message was invalid
+ *
+ * Error 2: Invalid player count in the seat message
+ *
+ * Error 3: Invalid ID in the seat message
+ */
+void serve_player(GameState* state, char* address, DoWhat doWhat);
+
+/*
+ * checks if there are any card on the board that the player can purchase.
+ * Only looks at the markets set in the players affordable mask.
  *
  * state: Contains all information needed to keep track of the game
  *
@@ -77,9 +109,11 @@ void player_loop(GameState* state, void (*doWhat)(GameState* state));
 int can_buy_card(GameState* state, int* cardIndexs, int pointMin, int player);
 
 /*
- * sends the wild message to standard out
+ * sets the action to be taking a wild token
+ *
+ * action: storage for the action
  */
-void take_wild(void);
+void take_wild(Action* action);
 
 /*
  * checks if the player calling the function can take tokens
@@ -91,14 +125,18 @@ void take_wild(void);
 bool can_take_tokens(GameState* state);
 
 /*
- * prints the take message to standard out
+ * sets the action to be taking tokens
+ *
+ * action: storage for the action
  *
  * tokens: the amount of tokens to be taken by the player
  */
-void take(long* tokens);
+void take(Action* action, long* tokens);
 
 /*
- * prints the purchase message to standard out
+ * sets the action to be purchasing a card
+ *
+ * action: storage for the action
  *
  * cardNum: the card index requested to be purchased
  *
@@ -106,7 +144,19 @@ void take(long* tokens);
  *
  * wild: the number of wild tokens the player wishes to use to buy the card
  */
-void purchase(int cardNum, long* tokens, long wild);
+void purchase(Action* action, int cardNum, long* tokens, long wild);
+
+/*
+ * prints the message for an action to standard out. The message will be one
+ * of the following
+ *
+ * "wild\n"
+ * "takeTP,TB,TY,TR\n"
+ * "purchaseC:TP,TB,TY,TR,TW\n"
+ *
+ * action: the action to be sent
+ */
+void send_action(Action* action);
 
 /*
  * will load the amount of tokens needed to purchase the card requested
@@ -0,0 +1,37 @@
+/* plugin.c
+ *
+ * Author: Michael Bossner
+ *
+ * plugin.c builds a player into a plugin the hub can load with dlopen.
+ * Compile with PLUGIN_NAME set to the name of the player e.g. "shenzi"
+ */
+
+#include <stdio.h>
+
+#include "plugin.h"
+#include "strategy.h"
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define MIN_PLAYERS 2
+
+////////////////////////////// Global Variables ///////////////////////////////
+
+/* Strategy of the player this plugin was built from */
+static DoWhat strategy = NULL;
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int plugin_init(int playerCount, int id) {
+    if (playerCount < MIN_PLAYERS || playerCount > MAX_PLAYERS || 
+            id < 0 || id >= playerCount) {
+        return FAIL;
+    }
+    strategy = find_strategy(PLUGIN_NAME);
+    return strategy != NULL;
+}
+
+void plugin_do_what(GameState* state, Action* action) {
+    strategy(state, action);
+}
@@ -0,0 +1,48 @@
+/* plugin.h
+ *
+ * Author: Michael Bossner
+ *
+ * plugin.h header file for plugin.c. Declares the functions a player plugin
+ * exports so the hub can run the player inside its own process.
+ */
+
+#ifndef PLUGIN_H
+#define PLUGIN_H
+
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define PLUGIN_INIT "plugin_init"
+#define PLUGIN_DO_WHAT "plugin_do_what"
+
+/* Type of the plugin_init function */
+typedef int (*PluginInit)(int playerCount, int id);
+
+///////////////////////// Public Function Prototypes //////////////////////////
+
+/*
+ * Prepares the plugin to play in a game. Called once for each player the 
+ * plugin is used for.
+ *
+ * playerCount: number of players in the game. Must be from 2 to 26
+ *
+ * id: index of the player the plugin will play as. Must be less than
+ *     playerCount
+ *
+ * return: returns 0 if the arguments are invalid else returns 1
+ */
+int plugin_init(int playerCount, int id);
+
+/*
+ * Chooses the action for the player who's turn it is. The hub passes its
+ * own game state which must not be changed. state->currentPlayer is the
+ * player choosing the action.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * action: storage for the chosen action
+ */
+void plugin_do_what(GameState* state, Action* action);
+
+#endif
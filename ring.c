@@ -0,0 +1,253 @@
+/* ring.c
+ *
+ * Author: Michael Bossner
+ *
+ * ring.c contains the shared memory rings used by the shm transport
+ */
+
+#define _GNU_SOURCE // memfd_create, fopencookie
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "ring.h"
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define LINK_NAME "austerity"
+#define WAKE_ALL 0x7fffffff
+#define FAILED -1
+#define LOAD(place) __atomic_load_n(place, __ATOMIC_SEQ_CST)
+#define STORE(place, value) __atomic_store_n(place, value, __ATOMIC_SEQ_CST)
+#define ADD(place, value) __atomic_add_fetch(place, value, __ATOMIC_SEQ_CST)
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Waits until a condition on a ring is true. Busy polls first for
+ * end->spin microseconds and then sleeps on the bell in slices so the peer
+ * can be checked.
+ *
+ * end: end of the ring being waited on
+ *
+ * bell: bell rung when the condition may have changed
+ *
+ * ready: checks the condition
+ *
+ * return: returns true if the condition is true or false if the peer went
+ *         away first
+ */
+static bool wait_ring(RingEnd* end, Bell* bell, bool (*ready)(RingEnd*));
+
+/*
+ * Checks if a ring has space for more data or has data to be read
+ *
+ * end: end of the ring
+ *
+ * return: returns true if there is space or data else false
+ */
+static bool has_space(RingEnd* end);
+static bool has_data_or_closed(RingEnd* end);
+
+/*
+ * fopencookie() functions of a ring stream. See the cookie_io_functions_t
+ * documentation.
+ */
+static ssize_t read_stream(void* cookie, char* data, size_t length);
+static ssize_t write_stream(void* cookie, const char* data, size_t length);
+static int close_stream(void* cookie);
+
+////////////////////////////////// Functions //////////////////////////////////
+
+SharedLink* create_link(int* fd) {
+    SharedLink* link;
+
+    if ((*fd = memfd_create(LINK_NAME, MFD_CLOEXEC)) == FAILED) {
+        return NULL;
+    } else if (ftruncate(*fd, sizeof(SharedLink)) == FAILED ||
+            (link = attach_link(*fd)) == NULL) {
+        close(*fd);
+        return NULL;
+    }
+    return link; // a new memfd is all zeros so every ring is empty
+}
+
+SharedLink* attach_link(int fd) {
+    SharedLink* link = mmap(NULL, sizeof(SharedLink), PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+
+    return (link == MAP_FAILED) ? NULL : link;
+}
+
+void ring_bell(Bell* bell) {
+    ADD(&bell->rings, 1);
+    if (LOAD(&bell->sleepers) > 0) {
+        syscall(SYS_futex, &bell->rings, FUTEX_WAKE, WAKE_ALL, NULL, NULL, 0);
+    }
+}
+
+void wait_bell(Bell* bell, unsigned int seen, long long timeout) {
+    struct timespec wait = {timeout / US_PER_SEC,
+            (timeout % US_PER_SEC) * MS_PER_SEC};
+
+    ADD(&bell->sleepers, 1);
+    // returns straight away if the bell was rung since it was seen
+    syscall(SYS_futex, &bell->rings, FUTEX_WAIT, seen,
+            timeout < 0 ? NULL : &wait, NULL, 0);
+    ADD(&bell->sleepers, -1);
+}
+
+unsigned int seen_bell(Bell* bell) {
+    return LOAD(&bell->rings);
+}
+
+bool ring_has_data(RingEnd* end) {
+    return LOAD(&end->ring->head) != LOAD(&end->ring->tail);
+}
+
+bool ring_has_ended(RingEnd* end) {
+    return LOAD(&end->ring->closed) || 
+            (end->gone != NULL && end->gone(end->peer));
+}
+
+int ring_write(RingEnd* end, const char* data, int length) {
+    Ring* ring = end->ring;
+    int written = 0;
+
+    while (written < length) {
+        if (!has_space(end) && !wait_ring(end, &ring->space, has_space)) {
+            return FAILED;
+        }
+        unsigned int head = LOAD(&ring->head);
+        unsigned int space = RING_SIZE - (head - LOAD(&ring->tail));
+        unsigned int start = head % RING_SIZE;
+        unsigned int chunk = length - written;
+
+        if (chunk > space) {
+            chunk = space;
+        }
+        if (chunk > RING_SIZE - start) { // wraps around the end
+            memcpy(&ring->buffer[start], &data[written], RING_SIZE - start);
+            memcpy(ring->buffer, &data[written + RING_SIZE - start],
+                    chunk - (RING_SIZE - start));
+        } else {
+            memcpy(&ring->buffer[start], &data[written], chunk);
+        }
+        STORE(&ring->head, head + chunk);
+        ring_bell(end->bell);
+        written += chunk;
+    }
+    return length;
+}
+
+int ring_read(RingEnd* end, char* data, int length) {
+    Ring* ring = end->ring;
+    unsigned int tail = LOAD(&ring->tail);
+    unsigned int waiting = LOAD(&ring->head) - tail;
+    unsigned int start = tail % RING_SIZE;
+
+    if (waiting == 0) {
+        if (ring_has_ended(end) && LOAD(&ring->head) == tail) {
+            return 0;
+        }
+        errno = EAGAIN;
+        return FAILED;
+    }
+    if (waiting > (unsigned int)length) {
+        waiting = length;
+    }
+    if (waiting > RING_SIZE - start) { // wraps around the end
+        memcpy(data, &ring->buffer[start], RING_SIZE - start);
+        memcpy(&data[RING_SIZE - start], ring->buffer,
+                waiting - (RING_SIZE - start));
+    } else {
+        memcpy(data, &ring->buffer[start], waiting);
+    }
+    STORE(&ring->tail, tail + waiting);
+    ring_bell(&ring->space);
+    return waiting;
+}
+
+int ring_read_wait(RingEnd* end, char* data, int length) {
+    int got;
+
+    while ((got = ring_read(end, data, length)) == FAILED) {
+        if (!wait_ring(end, &end->ring->data, has_data_or_closed)) {
+            return 0; // writer went away
+        }
+    }
+    return got;
+}
+
+void ring_close(RingEnd* end) {
+    STORE(&end->ring->closed, 1);
+    ring_bell(end->bell);
+}
+
+FILE* open_ring_stream(RingEnd* end, const char* mode) {
+    cookie_io_functions_t functions = {
+        .read = read_stream,
+        .write = write_stream,
+        .seek = NULL,
+        .close = close_stream,
+    };
+    return fopencookie(end, mode, functions);
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static bool wait_ring(RingEnd* end, Bell* bell, bool (*ready)(RingEnd*)) {
+    long long spinEnd = time_now_us() + end->spin;
+
+    while (end->spin > 0 && time_now_us() < spinEnd) {
+        if (ready(end)) {
+            return true;
+        }
+    }
+    FOREVER {
+        unsigned int seen = seen_bell(bell);
+        if (ready(end)) {
+            return true;
+        } else if (end->gone != NULL && end->gone(end->peer)) {
+            return false;
+        }
+        wait_bell(bell, seen, WAIT_SLICE);
+    }
+}
+
+//
+static bool has_space(RingEnd* end) {
+    return LOAD(&end->ring->head) - LOAD(&end->ring->tail) < RING_SIZE;
+}
+
+//
+static bool has_data_or_closed(RingEnd* end) {
+    return ring_has_data(end) || LOAD(&end->ring->closed);
+}
+
+//
+static ssize_t read_stream(void* cookie, char* data, size_t length) {
+    return ring_read_wait(cookie, data, length);
+}
+
+//
+static ssize_t write_stream(void* cookie, const char* data, size_t length) {
+    return ring_write(cookie, data, length);
+}
+
+//
+static int close_stream(void* cookie) {
+    RingEnd* end = cookie;
+
+    if (end->bell != NULL) { // writing end
+        ring_close(end);
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+/* ring.h
+ *
+ * Author: Michael Bossner
+ *
+ * ring.h header file for ring.c
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define SHM_ENV "AUSTERITY_SHM"
+#define SHM_FD 3
+#define WAIT_SLICE 10000 // microseconds to sleep before checking the peer
+
+///////////////////////// Public Function Prototypes //////////////////////////
+
+/*
+ * Creates the shared memory used by the shm transport. The memory is a 
+ * memfd so it can be passed to players as a file descriptor
+ *
+ * fd: storage for the file descriptor of the memory. It is close on exec
+ *
+ * return: returns the mapped memory or NULL if it could not be created
+ */
+SharedLink* create_link(int* fd);
+
+/*
+ * Maps the shared memory of the shm transport passed in by the hub
+ *
+ * fd: file descriptor of the memory
+ *
+ * return: returns the mapped memory or NULL if it could not be mapped
+ */
+SharedLink* attach_link(int fd);
+
+/*
+ * Rings a bell waking everything sleeping on it. Only makes a system call
+ * if something is sleeping. Safe to call from a signal handler.
+ *
+ * bell: bell to ring
+ */
+void ring_bell(Bell* bell);
+
+/*
+ * Sleeps on a bell until it is rung or the timeout runs out. The bell must
+ * have been read with seen_bell() before checking whatever is being waited
+ * for so that a ring in between is not missed.
+ *
+ * bell: bell to sleep on
+ *
+ * seen: value returned by seen_bell()
+ *
+ * timeout: microseconds to sleep at most. Negative sleeps until rung
+ */
+void wait_bell(Bell* bell, unsigned int seen, long long timeout);
+
+/*
+ * Reads how many times a bell has been rung
+ *
+ * bell: bell to read
+ *
+ * return: returns the value to pass to wait_bell()
+ */
+unsigned int seen_bell(Bell* bell);
+
+/*
+ * Checks if a ring has data waiting to be read
+ *
+ * end: reading end of the ring
+ *
+ * return: returns true if there is data else false
+ */
+bool ring_has_data(RingEnd* end);
+
+/*
+ * Checks if the writer of a ring has closed it or gone away
+ *
+ * end: reading end of the ring
+ *
+ * return: returns true if nothing more will be written else false
+ */
+bool ring_has_ended(RingEnd* end);
+
+/*
+ * Writes all of a message into a ring. If the ring is full this waits for
+ * the reader to make space, busy polling first for end->spin microseconds.
+ *
+ * end: writing end of the ring
+ *
+ * data: message to write
+ *
+ * length: length of the message
+ *
+ * return: returns length or -1 if the reader went away while waiting
+ */
+int ring_write(RingEnd* end, const char* data, int length);
+
+/*
+ * Reads whatever is in a ring without waiting. Works like read() on a non
+ * blocking file descriptor.
+ *
+ * end: reading end of the ring
+ *
+ * data: storage for the data read
+ *
+ * length: most bytes to read
+ *
+ * return: returns the number of bytes read. 0 if the ring is empty and 
+ *         the writer closed it or went away. -1 if the ring is empty.
+ */
+int ring_read(RingEnd* end, char* data, int length);
+
+/*
+ * Reads whatever is in a ring and waits for data if it is empty, busy 
+ * polling first for end->spin microseconds. Works like read() on a 
+ * blocking file descriptor.
+ *
+ * end: reading end of the ring
+ *
+ * data: storage for the data read
+ *
+ * length: most bytes to read
+ *
+ * return: returns the number of bytes read or 0 if the ring is empty and
+ *         the writer closed it or went away
+ */
+int ring_read_wait(RingEnd* end, char* data, int length);
+
+/*
+ * Marks a ring closed so the reader gets end of file once it is empty
+ *
+ * end: writing end of the ring
+ */
+void ring_close(RingEnd* end);
+
+/*
+ * Opens a stdio stream on a ring. Reading waits for data, busy polling 
+ * first for end->spin microseconds. Closing a stream opened for writing
+ * closes the ring.
+ *
+ * end: end of the ring. Must live as long as the stream
+ *
+ * mode: "r" for the reading end or "w" for the writing end
+ *
+ * return: returns the stream or NULL if it could not be opened
+ */
+FILE* open_ring_stream(RingEnd* end, const char* mode);
+
+#endif
@@ -0,0 +1,184 @@
+/* rules.c
+ *
+ * Author: Michael Bossner
+ *
+ * rules.c contains the rules of the game. Actions are checked and taken
+ * here for both the hub and the players without any I/O so the game state
+ * can only be changed one way.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "rules.h"
+#include "lib.h"
+#include "board.h"
+#include "afford.h"
+#include "token.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define WILD_TOKENS MAX_TOKEN_COLOUR
+#define TAKE_COUNT 3
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Checks that a purchase is legal
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player buying
+ *
+ * action: the purchase. Holds the card index and the tokens to pay with
+ *
+ * return: returns RULE_APPLIED if the purchase is legal else the reason it
+ *         is not
+ */
+static int check_purchase(GameState* state, int player, Action* action);
+
+/*
+ * Checks that a take is legal
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * action: the take. Holds the tokens to be taken
+ *
+ * return: returns RULE_APPLIED if the take is legal else RULE_BAD_TAKE
+ */
+static int check_take(GameState* state, Action* action);
+
+/*
+ * Updates the state for a legal purchase
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player buying
+ *
+ * action: the purchase
+ *
+ * bought: storage for the card bought. May be NULL
+ */
+static void purchase(GameState* state, int player, Action* action,
+        Card* bought);
+
+/*
+ * Updates the state for a legal take
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player taking
+ *
+ * action: the take
+ */
+static void take(GameState* state, int player, Action* action);
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int check_action(GameState* state, int player, Action* action) {
+    int used = (action->type == ACTION_PURCHASE) ? MAX_TOKEN_COLOUR + 1 :
+            (action->type == ACTION_TAKE) ? MAX_TOKEN_COLOUR : 0;
+
+    if (player < 0 || player >= state->player.count) {
+        return RULE_BAD_PLAYER;
+    }
+    for (int i = 0; i < used; i++) { // only plugins can send negatives
+        if (action->tokens[i] < 0) {
+            return RULE_BAD_ACTION;
+        }
+    }
+    switch (action->type) {
+        case ACTION_WILD:
+            return RULE_APPLIED;
+        case ACTION_PURCHASE:
+            return check_purchase(state, player, action);
+        case ACTION_TAKE:
+            return check_take(state, action);
+        default:
+            return RULE_BAD_ACTION;
+    }
+}
+
+int apply_action(GameState* state, int player, Action* action, Card* bought) {
+    int result = check_action(state, player, action);
+
+    if (result != RULE_APPLIED) {
+        return result;
+    }
+    force_action(state, player, action, bought);
+    return RULE_APPLIED;
+}
+
+void force_action(GameState* state, int player, Action* action, 
+        Card* bought) {
+    switch (action->type) {
+        case ACTION_WILD:
+            state->player.wildPile[player]++;
+            break;
+        case ACTION_PURCHASE:
+            purchase(state, player, action, bought);
+            break;
+        case ACTION_TAKE:
+            take(state, player, action);
+            break;
+    }
+    update_affordable(state, player);
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int check_purchase(GameState* state, int player, Action* action) {
+    if (check_market_card(state, action->boardIndex) == NULL) {
+        return RULE_NO_MARKET;
+    } else if (!IS_AFFORDABLE(state->player.affordable[player], 
+            action->boardIndex)) {
+        return RULE_CANNOT_AFFORD;
+    }
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        if (state->player.tokens[player][colour] < action->tokens[colour]) { 
+            return RULE_CANNOT_AFFORD; // player does not have that many
+        }
+    }
+    return RULE_APPLIED;
+}
+
+//
+static int check_take(GameState* state, Action* action) {
+    int count = 0;
+
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        if (action->tokens[colour] != 1 && action->tokens[colour] != 0) {
+            return RULE_BAD_TAKE;
+        } else if (action->tokens[colour] > state->tokenPile.pile[colour]) {
+            return RULE_BAD_TAKE; // trying to take more then there is
+        }
+        count += action->tokens[colour];
+    }
+    return (count == TAKE_COUNT) ? RULE_APPLIED : RULE_BAD_TAKE;
+}
+
+//
+static void purchase(GameState* state, int player, Action* action,
+        Card* bought) {
+    Card card;
+
+    purchase_card(state, action->boardIndex, &card);
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        state->player.tokens[player][colour] -= action->tokens[colour];
+        state->tokenPile.pile[colour] += action->tokens[colour];
+    }
+    state->player.wildPile[player] -= action->tokens[WILD_TOKENS];
+    add_discount(state, card.discount, player);
+    state->player.scoreCard[player] += card.points;
+    if (bought != NULL) {
+        *bought = card;
+    }
+}
+
+//
+static void take(GameState* state, int player, Action* action) {
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        state->tokenPile.pile[colour] -= action->tokens[colour];
+        state->player.tokens[player][colour] += action->tokens[colour];
+    }
+}
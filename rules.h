@@ -0,0 +1,84 @@
+/* rules.h
+ *
+ * Author: Michael Bossner
+ *
+ * rules.h header file for rules.c
+ */
+
+#ifndef RULES_H
+#define RULES_H
+
+#include <stdbool.h>
+
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+/* Results of checking or applying an action */
+enum RuleResult {
+    RULE_APPLIED, // the action is legal
+    RULE_BAD_ACTION, // not an action or uses negative tokens
+    RULE_BAD_PLAYER, // no such player
+    RULE_NO_MARKET, // no market at the board index
+    RULE_CANNOT_AFFORD, // the purchase is not legal
+    RULE_BAD_TAKE, // the take is not legal
+};
+
+///////////////////////// Public Functions Prototypes /////////////////////////
+
+/*
+ * Checks that an action is legal for a player in the current game state.
+ * A purchase must be of a market the player can afford using no more
+ * tokens than they have. A take must be exactly 3 tokens, no more than 1 of
+ * each colour, and only from piles that are not empty. A wild is always
+ * legal.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player taking the action
+ *
+ * action: action to check
+ *
+ * return: returns RULE_APPLIED if the action is legal else the RuleResult
+ *         saying why it is not
+ */
+int check_action(GameState* state, int player, Action* action);
+
+/*
+ * Takes an action for a player if it is legal. The tokens, wild tokens,
+ * discounts, score and affordable markets of the player, the token pile and
+ * the board are updated. The market bought is not refilled as the next card
+ * comes from the hub. Nothing is printed, allocated or exited on so the hub
+ * and the players can share it.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player taking the action
+ *
+ * action: action to take
+ *
+ * bought: storage for the card bought by a purchase. May be NULL
+ *
+ * return: returns RULE_APPLIED if the action was taken else the RuleResult
+ *         from check_action() and the state is not changed
+ */
+int apply_action(GameState* state, int player, Action* action, Card* bought);
+
+/*
+ * Takes an action for a player without checking it is legal. Players use
+ * it to follow an action the hub sent that their own copy of the game does
+ * not allow, the same as they did before the rules were shared. The player
+ * and the market of a purchase must exist.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: player taking the action
+ *
+ * action: action to take
+ *
+ * bought: storage for the card bought by a purchase. May be NULL
+ */
+void force_action(GameState* state, int player, Action* action, 
+        Card* bought);
+
+#endif
@@ -0,0 +1,272 @@
+/* strategy.c
+ *
+ * Author: Michael Bossner
+ *
+ * strategy.c contains the strategies of the shenzi, banzai and ed players
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "strategy.h"
+#include "player.h"
+#include "board.h"
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define SHENZI_POINT_MIN 0
+#define BANZAI_POINT_MIN 1
+#define BANZAI_TOKEN_MIN 3
+#define ED_POINT_MIN 0
+#define IDENTIFIED 0
+#define UNIDENTIFIED -1
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * selects which tokens ed would like to pick up for a take action
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * tokens: the tokens that ed would like to pick up
+ *
+ * neededTokens: the tokens ed need to pick up to buy his card
+ */
+static void select_tokens(GameState* state, long* tokens, long* neededTokens);
+
+/*
+ * finds out if ed can buy his identified card
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * identifiedCard: index of the card Ed would like to purchase
+ *
+ * neededTokens: the tokens that needs in order to buy his card
+ *
+ * canBuy: flag saying if he can buy the card or not
+ */
+static void can_buy_identified(GameState* state, int identifiedCard, 
+        long* neededTokens, bool* canBuy);
+
+////////////////////////////////// Functions //////////////////////////////////
+
+void shenzi_do_what(GameState* state, Action* action) {
+    int cardIndexs[MAX_MARKETS];
+    int canPurch;
+    long tokens[MAX_TOKEN_COLOUR];
+    long wild;
+    
+    if ((canPurch = can_buy_card(state, cardIndexs, SHENZI_POINT_MIN, 
+            THIS_PLAYER))) {
+    // 1. buy card      
+        if (canPurch == 1) { // can only buy one
+            load_tokens(state, cardIndexs[(canPurch - 1)], tokens, &wild);
+            purchase(action, cardIndexs[(canPurch - 1)], tokens, wild);
+        } else if (find_highest_index(state, cardIndexs, &canPurch) 
+                == 1) { // highest points
+            load_tokens(state, cardIndexs[(canPurch - 1)], tokens, &wild);
+            purchase(action, cardIndexs[(canPurch - 1)], tokens, wild);
+        } else if (find_lowest_cost(state, &canPurch, cardIndexs) == 1) {
+            // lowest cost
+            load_tokens(state, cardIndexs[(canPurch - 1)], tokens, &wild);
+            purchase(action, cardIndexs[(canPurch - 1)], tokens, wild);
+        } else { // youngest
+            load_tokens(state, cardIndexs[(canPurch - 1)], tokens, &wild);
+            purchase(action, cardIndexs[(canPurch - 1)], tokens, wild);
+        }
+    } else if (can_take_tokens(state)) { // 2. take tokens
+        int tokenCount = 0;
+        for (int i = 0; i < MAX_TOKEN_COLOUR; i++) {
+            if ((state->tokenPile.pile[i] > 0) && (tokenCount < 3)) {
+                tokens[i] = 1;
+                tokenCount++;
+            } else {
+                tokens[i] = 0;
+            }
+        }
+        take(action, tokens);
+    } else { // 3. take wild
+        take_wild(action);
+    }
+}
+
+void banzai_do_what(GameState* state, Action* action) {
+    int cardIndexs[MAX_MARKETS];
+    int canPurch;
+    long tokens[MAX_TOKEN_COLOUR];
+    long numTokens = state->player.wildPile[THIS_PLAYER];
+    long wild;
+
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) { // count tokens
+        numTokens += state->player.tokens[THIS_PLAYER][colour];
+    }
+    if (numTokens < BANZAI_TOKEN_MIN && can_take_tokens(state)) { 
+        // 1. take tokens
+        int tokenCount = 0;
+        int colour = YELLOW;
+        while (colour != RED) {
+            if (colour < PURPLE) {
+                colour = RED;
+            } 
+            if ((state->tokenPile.pile[colour] > 0) && 
+                    (tokenCount < BANZAI_TOKEN_MIN)) {
+                tokens[colour] = 1;
+                tokenCount++;
+            } else {
+                tokens[colour] = 0;
+            }
+            if (colour != RED) {
+                colour--;
+            }
+        }
+        take(action, tokens);
+    } else if ((canPurch = can_buy_card(state, cardIndexs, BANZAI_POINT_MIN, 
+            THIS_PLAYER))) { // 2. Purchase card
+        if (canPurch == 1) { // can only buy one
+            load_tokens(state, cardIndexs[(canPurch - 1)], tokens, &wild);
+            purchase(action, cardIndexs[(canPurch - 1)], tokens, wild);
+        } else if (find_highest_cost(state, &canPurch, cardIndexs)) { 
+        // most expensive total cost
+            load_tokens(state, cardIndexs[(canPurch - 1)], tokens, &wild);
+            purchase(action, cardIndexs[(canPurch - 1)], tokens, wild);
+        } else if (highest_wild_cost(state, &canPurch, cardIndexs)) {
+            load_tokens(state, cardIndexs[(canPurch - 1)], tokens, &wild);
+            purchase(action, cardIndexs[(canPurch - 1)], tokens, wild);
+        } else { // oldest card
+            load_tokens(state, cardIndexs[0], tokens, &wild);
+            purchase(action, cardIndexs[(canPurch - 1)], tokens, wild);
+        }
+    } else { // 3. take wild
+        take_wild(action);
+    }
+}
+
+void ed_do_what(GameState* state, Action* action) {
+    int canPurch[MAX_PLAYERS];
+    int cardIndexs[MAX_PLAYERS][MAX_MARKETS];
+    int highest = 0;
+    int identifiedCard = UNIDENTIFIED;
+    long tokens[MAX_TOKEN_COLOUR];
+    long neededTokens[MAX_TOKEN_COLOUR];
+    bool canBuy = true;
+    long wild;
+
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) { // inits tokens
+        neededTokens[colour] = 0;
+        tokens[colour] = 0;
+    }
+    for (int player = (THIS_PLAYER + 1); ; player++) {
+        if (player >= (state->player.count)) { // wrap back to first player
+            player = 0;
+        } 
+        if (player == THIS_PLAYER) { // check everyone
+            break;
+        }
+        if ((canPurch[player] = can_buy_card(state, cardIndexs[player], 
+                ED_POINT_MIN, player))) {
+        // finds all cards player can buy
+            find_highest_index(state, cardIndexs[player], &canPurch[player]);
+            // finds the highest point cards. If more then 1 picks the oldest
+            if (highest < (check_market_card
+                    (state, cardIndexs[player][0])->points)) {
+            // found the current highest point card
+                highest = (check_market_card
+                        (state, cardIndexs[player][0])->points);
+                identifiedCard = cardIndexs[player][0];
+            }
+        }
+    }   
+    if (identifiedCard >= IDENTIFIED) {
+        can_buy_identified(state, identifiedCard, neededTokens, &canBuy);
+    }
+    if (canBuy && (identifiedCard >= IDENTIFIED)) { // 1. purchase card
+        load_tokens(state, identifiedCard, tokens, &wild);
+        purchase(action, identifiedCard, tokens, wild);
+    } else if (can_take_tokens(state)) { // 2. take tokens
+        select_tokens(state, tokens, neededTokens);
+        take(action, tokens);
+    } else { // 3. take wild
+        take_wild(action);
+    }
+}
+
+DoWhat find_strategy(const char* name) {
+    if (strcmp(name, "shenzi") == 0) {
+        return shenzi_do_what;
+    } else if (strcmp(name, "banzai") == 0) {
+        return banzai_do_what;
+    } else if (strcmp(name, "ed") == 0) {
+        return ed_do_what;
+    } else {
+        return NULL;
+    }
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void select_tokens(GameState* state, long* tokens, long* neededTokens) {
+    int count = 0;
+
+    for (int i = 0; i < 2; i++) { // goes for neededTokens first
+        if (neededTokens[YELLOW] >= 1 || i == 1) {
+            if (state->tokenPile.pile[YELLOW] > 0 && tokens[YELLOW] == 0 &&
+                    count < 3) {
+                tokens[YELLOW]++;
+                count++;
+            }
+        }
+        if (neededTokens[RED] >= 1 || i == 1) {
+            if (state->tokenPile.pile[RED] > 0 && tokens[RED] == 0 && 
+                    count < 3) {
+                tokens[RED]++;
+                count++;
+            }
+        }
+        if (neededTokens[BROWN] >= 1 || i == 1) {
+            if (state->tokenPile.pile[BROWN] > 0 && tokens[BROWN] == 0 && 
+                    count < 3) {
+                tokens[BROWN]++;
+                count++;
+            }
+        }
+        if (neededTokens[PURPLE] >= 1 || i == 1) {
+            if (state->tokenPile.pile[PURPLE] > 0 && tokens[PURPLE] == 0 && 
+                    count < 3) {
+                tokens[PURPLE]++;
+                count++;
+            }
+        }
+    }
+}
+
+//
+static void can_buy_identified(GameState* state, int identifiedCard, 
+        long* neededTokens, bool* canBuy) {
+    long tempWild = state->player.wildPile[THIS_PLAYER];
+    for (int i = 0; i < MAX_TOKEN_COLOUR; i++) {
+        if ((state->player.tokens[THIS_PLAYER][i] + 
+                state->player.discountList[THIS_PLAYER][i] + tempWild) >= 
+                (check_market_card(state, identifiedCard)->cost[i])) {
+            // can afford colour
+            if ((state->player.tokens[THIS_PLAYER][i] + 
+                    state->player.discountList[THIS_PLAYER][i]) < 
+                    (check_market_card(state, 
+                    identifiedCard)->cost[i])) { // must use wild tokens
+                        
+                tempWild -= ((check_market_card(state, 
+                        identifiedCard)->cost[i]) - 
+                        (state->player.tokens[THIS_PLAYER][i] + 
+                        state->player.discountList[THIS_PLAYER][i]));
+                        
+                neededTokens[i] = (check_market_card(state, 
+                        identifiedCard)->cost[i]);
+            }       
+        } else { // cannot buy
+            *canBuy = false;
+            neededTokens[i] = (check_market_card(state, 
+                    identifiedCard)->cost[i]);
+        }
+    }
+}
\ No newline at end of file
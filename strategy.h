@@ -0,0 +1,66 @@
+/* strategy.h
+ *
+ * Author: Michael Bossner
+ *
+ * strategy.h header file for strategy.c
+ */
+
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include "lib.h"
+
+///////////////////////// Public Function Prototypes //////////////////////////
+
+/*
+ * Controls which action shenzi will take next dependent on the current game 
+ * state.
+ * 1. buy the card with the most points. Ties go to the lowest cost card
+ *    then the youngest card
+ * 2. take tokens in the order purple, brown, yellow, red
+ * 3. take a wild
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * action: storage for the action shenzi decides to take
+ */
+void shenzi_do_what(GameState* state, Action* action);
+
+/*
+ * Controls which action banzai will take next dependent on the current game 
+ * state.
+ * 1. take tokens in the order yellow, brown, purple, red if banzai has less
+ *    than 3 tokens
+ * 2. buy the most expensive card worth at least 1 point. Ties go to the 
+ *    card needing the most wild tokens
+ * 3. take a wild
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * action: storage for the action banzai decides to take
+ */
+void banzai_do_what(GameState* state, Action* action);
+
+/*
+ * Controls which action ed will take next dependent on the current game 
+ * state. Ed finds the card with the most points any other player can afford
+ * and buys it or takes tokens towards buying it. If he can't do either he
+ * takes a wild
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * action: storage for the action ed decides to take
+ */
+void ed_do_what(GameState* state, Action* action);
+
+/*
+ * finds the strategy of a player by the players name
+ *
+ * name: name of the player. Either "shenzi", "banzai" or "ed"
+ *
+ * return: returns the players strategy or NULL if there is no player with
+ *         that name
+ */
+DoWhat find_strategy(const char* name);
+
+#endif
@@ -0,0 +1,345 @@
+/* transport.c
+ *
+ * Author: Michael Bossner
+ *
+ * transport.c contains the ways the hub can be connected to players
+ */
+
+#define _GNU_SOURCE // pipe2, environ
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "transport.h"
+#include "lib.h"
+#include "comms.h"
+#include "ring.h"
+#include "game.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define STDIN 0
+#define STDOUT 1
+#define STDERR 2
+#define BUFFER 12 // fits any int with its sign and the '\0'
+#define FAILED -1
+#define ENV_BUFFER 64
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Starts a player connected to the hub with a pipe for each direction
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to start
+ *
+ * path: name of the player program to run
+ *
+ * return: returns 0 if the player could not be started else returns 1
+ */
+static int start_pipe(GameState* state, int player, char* path);
+
+/*
+ * Starts a player connected to the hub with a socketpair. Both the player's
+ * stdin and stdout are its end of the socketpair
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to start
+ *
+ * path: name of the player program to run
+ *
+ * return: returns 0 if the player could not be started else returns 1
+ */
+static int start_socket(GameState* state, int player, char* path);
+
+/*
+ * Starts a player connected to the hub with a ring in each direction in
+ * shared memory. The shared memory is made when the first shm player is 
+ * started and is passed to every shm player as file descriptor SHM_FD. The
+ * AUSTERITY_SHM environment variable tells the player to use it.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to start
+ *
+ * path: name of the player program to run
+ *
+ * return: returns 0 if the player could not be started else returns 1
+ */
+static int start_shm(GameState* state, int player, char* path);
+
+/*
+ * Starts a player process with posix_spawnp(). The actions must already 
+ * set up the player's stdin and stdout. Its stderr goes to /dev/null.
+ * posix_spawnp() does not copy the hub like fork() does so starting a
+ * player does not depend on the size of the hub.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to start
+ *
+ * path: name of the player program to run
+ *
+ * actions: file actions to take in the player. Destroyed once spawned
+ *
+ * env: environment of the player
+ *
+ * return: returns 0 if the program could not be run else returns 1
+ */
+static int spawn_player(GameState* state, int player, char* path, 
+        posix_spawn_file_actions_t* actions, char** env);
+
+/*
+ * Starts a player process with its stdin and stdout set to the given file
+ * descriptors
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player to start
+ *
+ * path: name of the player program to run
+ *
+ * input: file descriptor to become the player's stdin
+ *
+ * output: file descriptor to become the player's stdout
+ *
+ * return: returns 0 if the program could not be run else returns 1
+ */
+static int spawn_with_fds(GameState* state, int player, char* path, 
+        int input, int output);
+
+/*
+ * Checks if a player process has exited. Used as the PeerGone of the hubs
+ * ring ends.
+ *
+ * peer: pointer to the pid of the player
+ *
+ * return: returns true if the player has been reaped else false
+ */
+static bool is_player_gone(void* peer);
+
+/*
+ * Opens the hub's streams to a player
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player
+ *
+ * input: file descriptor the hub reads the player from
+ *
+ * output: file descriptor the hub writes to the player on
+ *
+ * return: returns 0 if the streams could not be opened else returns 1
+ */
+static int open_comms(GameState* state, int player, int input, int output);
+
+/* All transports that can be chosen with -m */
+static const Transport transports[] = {
+    {"pipe", start_pipe},
+    {"socket", start_socket},
+    {SHM_TRANSPORT, start_shm},
+};
+
+////////////////////////////////// Functions //////////////////////////////////
+
+const Transport* find_transport(const char* name) {
+    int count = sizeof(transports) / sizeof(Transport);
+
+    for (int i = 0; i < count; i++) {
+        if (strcmp(transports[i].name, name) == 0) {
+            return &transports[i];
+        }
+    }
+    return NULL;
+}
+
+int connect_daemon(GameState* state, int player, char* address) {
+    struct sockaddr_un unixAddress;
+    int daemon;
+    int output;
+
+    state->player.pidList[player] = 0;
+    if (!unix_address(&unixAddress, address) || (daemon = 
+            socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) == FAILED) {
+        return FAIL;
+    }
+    if (connect(daemon, (struct sockaddr*)&unixAddress, 
+            sizeof(struct sockaddr_un)) == FAILED || 
+            dprintf(daemon, SEAT_MESSAGE "%d:%d\n", state->player.count, 
+            player) < 0 || 
+            (output = fcntl(daemon, F_DUPFD_CLOEXEC, 0)) == FAILED) {
+        close(daemon);
+        return FAIL;
+    }
+    return open_comms(state, player, daemon, output);
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int start_pipe(GameState* state, int player, char* path) {
+    int readWrite[READ_WRITE];
+    int writeRead[READ_WRITE];
+
+    // close on exec so later players do not inherit these pipes
+    if (pipe2(readWrite, O_CLOEXEC) == FAILED) {
+        return FAIL;
+    } else if (pipe2(writeRead, O_CLOEXEC) == FAILED) {
+        close(readWrite[READ]);
+        close(readWrite[WRITE]);
+        return FAIL;
+    }
+    int started = spawn_with_fds(state, player, path, writeRead[READ], 
+            readWrite[WRITE]);
+
+    close(readWrite[WRITE]);
+    close(writeRead[READ]);
+    if (!started) {
+        close(readWrite[READ]);
+        close(writeRead[WRITE]);
+        return FAIL;
+    }
+    return open_comms(state, player, readWrite[READ], writeRead[WRITE]);
+}
+
+//
+static int start_socket(GameState* state, int player, char* path) {
+    int pair[READ_WRITE];
+    int output;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) == FAILED) {
+        return FAIL;
+    }
+    int started = spawn_with_fds(state, player, path, pair[WRITE], 
+            pair[WRITE]);
+
+    close(pair[WRITE]);
+    if (!started || 
+            (output = fcntl(pair[READ], F_DUPFD_CLOEXEC, 0)) == FAILED) {
+        close(pair[READ]);
+        return FAIL;
+    }
+    return open_comms(state, player, pair[READ], output);
+}
+
+//
+static int start_shm(GameState* state, int player, char* path) {
+    posix_spawn_file_actions_t actions;
+    char variable[ENV_BUFFER];
+    int count = 0;
+
+    if (state->player.link == NULL) {
+        if ((state->player.link = create_link(&state->player.linkFd)) 
+                == NULL) {
+            return FAIL;
+        }
+        sigStore.wakeBell = &state->player.link->hubBell;
+    }
+    while (environ[count] != NULL) {
+        count++;
+    }
+    char** env = malloc(sizeof(char*) * (count + 2));
+    if (env == NULL) {
+        return FAIL;
+    }
+    memcpy(env, environ, sizeof(char*) * count);
+    snprintf(variable, sizeof(variable), SHM_ENV "=%d", state->config.spin);
+    env[count] = variable;
+    env[count + 1] = NULL;
+
+    posix_spawn_file_actions_init(&actions); // rings replace stdin, stdout
+    posix_spawn_file_actions_addopen(&actions, STDIN, "/dev/null", 
+            O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDOUT, "/dev/null", 
+            O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, state->player.linkFd, SHM_FD);
+    int started = spawn_player(state, player, path, &actions, env);
+    free(env);
+    if (!started) {
+        return FAIL;
+    }
+
+    for (int direction = READ; direction <= WRITE; direction++) {
+        RingEnd* end = &state->player.rings[player][direction];
+        end->ring = &state->player.link->rings[player][direction];
+        end->bell = (direction == WRITE) ? &end->ring->data : NULL;
+        end->spin = state->config.spin;
+        end->gone = is_player_gone;
+        end->peer = &state->player.pidList[player];
+    }
+    state->player.commsList[player][READ] = 
+            open_ring_stream(&state->player.rings[player][READ], "r");
+    state->player.commsList[player][WRITE] = 
+            open_ring_stream(&state->player.rings[player][WRITE], "w");
+    if (state->player.commsList[player][READ] == NULL || 
+            state->player.commsList[player][WRITE] == NULL) {
+        return FAIL;
+    }
+    return VALID;
+}
+
+//
+static int spawn_player(GameState* state, int player, char* path, 
+        posix_spawn_file_actions_t* actions, char** env) {
+    char tempCount[BUFFER];          
+    char tempPlayer[BUFFER];
+    char* args[] = {path, tempCount, tempPlayer, NULL};
+    int result;
+
+    // setting up player args
+    snprintf(tempCount, sizeof(tempCount), "%d", state->player.count);
+    snprintf(tempPlayer, sizeof(tempPlayer), "%d", player);
+
+    posix_spawn_file_actions_addopen(actions, STDERR, "/dev/null", 
+            O_WRONLY, 0);
+    result = posix_spawnp(&state->player.pidList[player], path, actions, 
+            NULL, args, env);
+    posix_spawn_file_actions_destroy(actions);
+
+    return result == 0;
+}
+
+//
+static int spawn_with_fds(GameState* state, int player, char* path, 
+        int input, int output) {
+    posix_spawn_file_actions_t actions;
+
+    posix_spawn_file_actions_init(&actions); // redirecting streams
+    posix_spawn_file_actions_adddup2(&actions, output, STDOUT);
+    posix_spawn_file_actions_adddup2(&actions, input, STDIN);
+    return spawn_player(state, player, path, &actions, environ);
+}
+
+//
+static bool is_player_gone(void* peer) {
+    pid_t pid = *(pid_t*)peer;
+
+    for (int dead = 0; dead < sigStore.index; dead++) {
+        if (sigStore.children[dead] == pid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//
+static int open_comms(GameState* state, int player, int input, int output) {
+    FILE* reader = fdopen(input, "r");
+    FILE* writer = fdopen(output, "w");
+
+    if (reader == NULL || writer == NULL) {
+        reader == NULL ? close(input) : fclose(reader);
+        writer == NULL ? close(output) : fclose(writer);
+        return FAIL;
+    }
+    state->player.commsList[player][READ] = reader;
+    state->player.commsList[player][WRITE] = writer;
+    return VALID;
+}
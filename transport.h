@@ -0,0 +1,54 @@
+/* transport.h
+ *
+ * Author: Michael Bossner
+ *
+ * transport.h header file for transport.c
+ */
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define DEFAULT_TRANSPORT "pipe"
+#define SHM_TRANSPORT "shm"
+
+///////////////////////// Public Function Prototypes //////////////////////////
+
+/*
+ * Finds the transport with the given name. Transports are
+ *
+ * "pipe": the player's stdin and stdout are two pipes
+ * "socket": the player's stdin and stdout are one end of a socketpair
+ * "shm": a ring in shared memory for each direction. See ring.h
+ *
+ * name: name of the transport
+ *
+ * return: returns the transport or NULL if there is none with the name
+ */
+const Transport* find_transport(const char* name);
+
+/*
+ * Connects to a player daemon listening on a unix domain socket and gives
+ * it a seat in the game by sending
+ *
+ * "seatN:I\n"
+ * N: number of players in the game
+ * I: index of the player the daemon will play as
+ *
+ * The daemon then answers with the ready message like a started player.
+ * Daemon players are not child processes so their pid is set to 0.
+ *
+ * state: Contains all information needed to keep track of the game
+ *
+ * player: index of the player
+ *
+ * address: "unix:PATH" address the daemon listens on
+ *
+ * return: returns 0 if the daemon could not be connected to else returns 1
+ */
+int connect_daemon(GameState* state, int player, char* address);
+
+#endif
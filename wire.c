@@ -0,0 +1,292 @@
+/* wire.c
+ *
+ * Author: Michael Bossner
+ *
+ * wire.c packs and unpacks the records of the binary protocol. Each type of
+ * record has a fixed layout so it is read without any parsing.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "wire.h"
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+#define WILD_TOKENS MAX_TOKEN_COLOUR
+#define BYTE_BITS 8
+#define BYTE_MASK 0xff
+#define NARROW_BYTES 2
+#define WIDE_BYTES 4
+#define LONG_BYTES 8
+#define NARROW_MAX 0xffff
+#define WIDE_MAX 0xffffffffUL
+#define TYPE_MASK 0x3f
+
+/* The fields a type of record has after its type byte */
+typedef struct {
+    bool player; // has the player byte
+    bool market; // has the market byte
+    bool discount; // has the discount byte
+    int values; // number of values
+} Layout;
+
+/* Layout of each type of record */
+static const Layout layouts[WIRE_TYPES] = {
+    [WIRE_PURCHASED] = {true, true, false, RECORD_VALUES},
+    [WIRE_NEWCARD] = {false, false, true, RECORD_VALUES},
+    [WIRE_TOOK] = {true, false, false, MAX_TOKEN_COLOUR},
+    [WIRE_TOKENS] = {false, false, false, 1},
+    [WIRE_WILD] = {true, false, false, 0},
+    [WIRE_MARKETS] = {false, false, false, 1},
+};
+
+//////////////////////// Private Functions Prototypes /////////////////////////
+
+/*
+ * Writes a value little endian
+ *
+ * buffer: storage for the bytes
+ *
+ * value: value to write. Cut to the number of bytes
+ *
+ * bytes: number of bytes to write
+ */
+static void put_value(char* buffer, long value, int bytes);
+
+/*
+ * Reads a value written by put_value()
+ *
+ * buffer: the bytes of the value
+ *
+ * bytes: number of bytes in the value
+ *
+ * return: returns the value. Never negative unless it is long
+ */
+static long get_value(const char* buffer, int bytes);
+
+/*
+ * Works out how many bytes each value of a record takes from its type byte
+ *
+ * type: first byte of the record
+ *
+ * return: returns NARROW_BYTES, WIDE_BYTES or LONG_BYTES
+ */
+static int value_bytes(char type);
+
+////////////////////////////////// Functions //////////////////////////////////
+
+int encode_record(Record* record, char* buffer) {
+    const Layout* layout = &layouts[record->type];
+    int bytes = NARROW_BYTES;
+    int size = 1;
+
+    for (int i = 0; i < layout->values; i++) {
+        if ((unsigned long)record->values[i] > WIDE_MAX) {
+            bytes = LONG_BYTES;
+        } else if ((unsigned long)record->values[i] > NARROW_MAX && 
+                bytes == NARROW_BYTES) {
+            bytes = WIDE_BYTES;
+        }
+    }
+    buffer[0] = record->type | (bytes == WIDE_BYTES ? WIRE_WIDE : 0) | 
+            (bytes == LONG_BYTES ? WIRE_LONG : 0);
+    if (layout->player) {
+        buffer[size++] = record->player;
+    }
+    if (layout->market) {
+        buffer[size++] = record->market;
+    }
+    if (layout->discount) {
+        buffer[size++] = record->discount;
+    }
+    for (int i = 0; i < layout->values; i++, size += bytes) {
+        put_value(&buffer[size], record->values[i], bytes);
+    }
+    return size;
+}
+
+int record_size(char type) {
+    int kind = type & TYPE_MASK;
+
+    if (kind <= WIRE_NONE || kind >= WIRE_TYPES) {
+        return 1;
+    }
+    const Layout* layout = &layouts[kind];
+    return 1 + layout->player + layout->market + layout->discount + 
+            layout->values * value_bytes(type);
+}
+
+bool decode_record(const char* buffer, Record* record) {
+    int bytes = value_bytes(buffer[0]);
+    int size = 1;
+
+    memset(record, 0, sizeof(Record));
+    record->type = buffer[0] & TYPE_MASK;
+    if (record->type <= WIRE_NONE || record->type >= WIRE_TYPES) {
+        return false;
+    }
+    const Layout* layout = &layouts[record->type];
+    if (layout->player) {
+        record->player = (unsigned char)buffer[size++];
+    }
+    if (layout->market) {
+        record->market = (unsigned char)buffer[size++];
+    }
+    if (layout->discount) {
+        record->discount = buffer[size++];
+    }
+    for (int i = 0; i < layout->values; i++, size += bytes) {
+        record->values[i] = get_value(&buffer[size], bytes);
+    }
+    return record->market < MAX_MARKETS;
+}
+
+int format_record(Record* record, char* buffer, int size) {
+    long* values = record->values;
+    char player = player_int_to_char(record->player);
+    int length = 0;
+
+    switch (record->type) {
+        case WIRE_EOG:
+            length = snprintf(buffer, size, "eog\n");
+            break;
+        case WIRE_DOWHAT:
+            length = snprintf(buffer, size, "dowhat\n");
+            break;
+        case WIRE_PURCHASED:
+            length = snprintf(buffer, size,
+                    "purchased%c:%d:%ld,%ld,%ld,%ld,%ld\n", player,
+                    record->market, values[PURPLE], values[BROWN],
+                    values[YELLOW], values[RED], values[WILD_TOKENS]);
+            break;
+        case WIRE_NEWCARD:
+            length = snprintf(buffer, size, "newcard%c:%ld:%ld,%ld,%ld,%ld\n",
+                    record->discount, values[0], values[1 + PURPLE],
+                    values[1 + BROWN], values[1 + YELLOW], values[1 + RED]);
+            break;
+        case WIRE_TOOK:
+            length = snprintf(buffer, size, "took%c:%ld,%ld,%ld,%ld\n",
+                    player, values[PURPLE], values[BROWN], values[YELLOW],
+                    values[RED]);
+            break;
+        case WIRE_TOKENS:
+            length = snprintf(buffer, size, "tokens%ld\n", values[0]);
+            break;
+        case WIRE_WILD:
+            length = snprintf(buffer, size, "wild%c\n", player);
+            break;
+        case WIRE_NEWGAME:
+            length = snprintf(buffer, size, "newgame\n");
+            break;
+        case WIRE_MARKETS:
+            length = snprintf(buffer, size, "markets%ld\n", values[0]);
+            break;
+    }
+    if (length < 0) {
+        buffer[0] = '\0';
+        return 0;
+    } else if (length >= size) {
+        return size - 1;
+    }
+    return length;
+}
+
+void action_to_record(Record* record, int player, Action* action) {
+    memset(record, 0, sizeof(Record));
+    record->player = player;
+    switch (action->type) {
+        case ACTION_PURCHASE:
+            record->type = WIRE_PURCHASED;
+            record->market = action->boardIndex;
+            for (int i = 0; i <= WILD_TOKENS; i++) {
+                record->values[i] = action->tokens[i];
+            }
+            break;
+        case ACTION_TAKE:
+            record->type = WIRE_TOOK;
+            for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+                record->values[colour] = action->tokens[colour];
+            }
+            break;
+        case ACTION_WILD:
+            record->type = WIRE_WILD;
+            break;
+    }
+}
+
+bool record_to_action(Record* record, Action* action) {
+    memset(action, 0, sizeof(Action));
+    switch (record->type) {
+        case WIRE_PURCHASED:
+            action->type = ACTION_PURCHASE;
+            action->boardIndex = record->market;
+            for (int i = 0; i <= WILD_TOKENS; i++) {
+                action->tokens[i] = record->values[i];
+            }
+            return true;
+        case WIRE_TOOK:
+            action->type = ACTION_TAKE;
+            for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+                action->tokens[colour] = record->values[colour];
+            }
+            return true;
+        case WIRE_WILD:
+            action->type = ACTION_WILD;
+            return true;
+    }
+    return false;
+}
+
+void card_to_record(Record* record, Card* card) {
+    memset(record, 0, sizeof(Record));
+    record->type = WIRE_NEWCARD;
+    record->discount = card->discount;
+    record->values[0] = card->points;
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        record->values[1 + colour] = card->cost[colour];
+    }
+}
+
+bool record_to_card(Record* record, Card* card) {
+    if (record->discount != 'P' && record->discount != 'B' &&
+            record->discount != 'Y' && record->discount != 'R') {
+        return false;
+    }
+    card->discount = record->discount;
+    card->points = record->values[0];
+    for (int colour = 0; colour < MAX_TOKEN_COLOUR; colour++) {
+        card->cost[colour] = record->values[1 + colour];
+    }
+    return true;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void put_value(char* buffer, long value, int bytes) {
+    unsigned long bits = (unsigned long)value;
+
+    for (int i = 0; i < bytes; i++) { // lowest byte first
+        buffer[i] = (bits >> (i * BYTE_BITS)) & BYTE_MASK;
+    }
+}
+
+//
+static long get_value(const char* buffer, int bytes) {
+    unsigned long value = 0;
+
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = (value << BYTE_BITS) | (unsigned char)buffer[i];
+    }
+    return value;
+}
+
+//
+static int value_bytes(char type) {
+    if (type & WIRE_LONG) {
+        return LONG_BYTES;
+    }
+    return (type & WIRE_WIDE) ? WIDE_BYTES : NARROW_BYTES;
+}
@@ -0,0 +1,155 @@
+/* wire.h
+ *
+ * Author: Michael Bossner
+ *
+ * wire.h header file for wire.c
+ */
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#include "lib.h"
+
+/////////////////////////////////// Defines ///////////////////////////////////
+
+/* The hub offers the binary protocol to a player that is ready by sending
+ * WIRE_OFFER as a text line. The player replies with WIRE_OFFER to switch
+ * both directions to records or WIRE_DECLINE to keep using text. An offer
+ * of any other version starting with WIRE_PREFIX is declined */
+#define WIRE_VERSION 2
+#define WIRE_PREFIX "binary"
+#define WIRE_OFFER "binary2"
+#define WIRE_DECLINE "text"
+
+/* A record starts with its type byte followed by the player, market and
+ * discount bytes its type uses and then each of its values little endian.
+ * Values are 2 bytes unless WIRE_WIDE is set in the type byte when they
+ * are 4 or WIRE_LONG is set when they are 8 so the size of every record is
+ * known from its type byte */
+#define WIRE_WIDE 0x80
+#define WIRE_LONG 0x40
+#define RECORD_VALUES 5
+#define MAX_RECORD 43 // purchased with long values
+
+/* Type of each record. The same as the text message it stands for */
+enum WireType {
+    WIRE_NONE,
+    WIRE_EOG, // "eog"
+    WIRE_DOWHAT, // "dowhat"
+    WIRE_PURCHASED, // "purchased" or a players "purchase"
+    WIRE_NEWCARD, // "newcard"
+    WIRE_TOOK, // "took" or a players "take"
+    WIRE_TOKENS, // "tokens"
+    WIRE_WILD, // "wild" from the hub or a player
+    WIRE_NEWGAME, // "newgame"
+    WIRE_MARKETS, // "markets"
+    WIRE_TYPES,
+};
+
+/* A Record is a message of the binary protocol. Only the fields its type
+ * uses are sent, the rest are 0 */
+typedef struct {
+    int type; // see WireType enum
+    int player; // player who took the action. Only set by the hub
+    int market; // market purchased
+    char discount; // discount of a new card
+    // tokens of each colour then wild, points then each cost of a new card
+    // or the count of tokens and markets
+    long values[RECORD_VALUES];
+} Record;
+
+///////////////////////// Public Function Prototypes //////////////////////////
+
+/*
+ * Packs a record into its binary form. Values are only made wide if one
+ * does not fit in 2 bytes and long if one does not fit in 4 so every value
+ * is sent in full.
+ *
+ * record: record to pack
+ *
+ * buffer: storage for the record. Must be MAX_RECORD in size
+ *
+ * return: returns the size of the packed record
+ */
+int encode_record(Record* record, char* buffer);
+
+/*
+ * Works out the size of a packed record from its type byte
+ *
+ * type: first byte of the record
+ *
+ * return: returns the size of the record. 1 if the type is unknown so the
+ *         byte is handed out on its own and rejected by decode_record()
+ */
+int record_size(char type);
+
+/*
+ * Unpacks a record from its binary form
+ *
+ * buffer: the record_size() bytes of the record
+ *
+ * record: storage for the record
+ *
+ * return: returns false if the type is unknown or the market is too big
+ *         else true
+ */
+bool decode_record(const char* buffer, Record* record);
+
+/*
+ * Writes the text message a record stands for the same way the hub
+ * formats it, ending in a newline
+ *
+ * record: record to write
+ *
+ * buffer: storage for the message
+ *
+ * size: size of buffer
+ *
+ * return: returns the length of the message. Messages longer than the
+ *         buffer are cut short
+ */
+int format_record(Record* record, char* buffer, int size);
+
+/*
+ * Fills in a record of an action
+ *
+ * record: storage for the record
+ *
+ * player: index of the player who took the action
+ *
+ * action: action taken
+ */
+void action_to_record(Record* record, int player, Action* action);
+
+/*
+ * Reads the action out of a purchased, took or wild record
+ *
+ * record: record to read
+ *
+ * action: storage for the action
+ *
+ * return: returns false if the record is not an action else true
+ */
+bool record_to_action(Record* record, Action* action);
+
+/*
+ * Fills in a newcard record
+ *
+ * record: storage for the record
+ *
+ * card: card that was added
+ */
+void card_to_record(Record* record, Card* card);
+
+/*
+ * Reads the card out of a newcard record
+ *
+ * record: record to read
+ *
+ * card: storage for the card
+ *
+ * return: returns false if the discount is not a colour else true
+ */
+bool record_to_card(Record* record, Card* card);
+
+#endif